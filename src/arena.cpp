@@ -0,0 +1,97 @@
+#include "arena.h"
+
+#include <new>
+
+using namespace std;
+
+static atomic<uint64_t> nextEpoch{1};
+
+// A thread's position in the block it is filling, for the few arenas it
+// used last.
+struct Cursor {
+  uint64_t epoch = 0;
+  char* next = nullptr;
+  char* end = nullptr;
+};
+
+static thread_local Arena* currentArena = nullptr;
+
+static const int CURSORS = 4;
+static thread_local Cursor cursors[CURSORS];
+static thread_local int nextCursor = 0;
+
+Arena::Arena(size_t blockSize) : blockSize(blockSize), epoch(nextEpoch.fetch_add(1)) {}
+
+Arena::~Arena() {
+  release();
+}
+
+void Arena::release() {
+  lock_guard<mutex> guard(lock);
+  for (auto& block : blocks) ::operator delete(block.first);
+  blocks.clear();
+  epoch.store(nextEpoch.fetch_add(1));
+}
+
+size_t Arena::blockCount() const {
+  lock_guard<mutex> guard(lock);
+  return blocks.size();
+}
+
+size_t Arena::bytesReserved() const {
+  lock_guard<mutex> guard(lock);
+  size_t total = 0;
+  for (const auto& block : blocks) total += block.second;
+  return total;
+}
+
+char* Arena::newBlock(size_t size) {
+  char* block = static_cast<char*>(::operator new(size));
+  lock_guard<mutex> guard(lock);
+  blocks.emplace_back(block, size);
+  return block;
+}
+
+static char* alignUp(char* p, size_t alignment) {
+  uintptr_t address = reinterpret_cast<uintptr_t>(p);
+  return reinterpret_cast<char*>((address + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1));
+}
+
+void* Arena::do_allocate(size_t bytes, size_t alignment) {
+  allocations.fetch_add(1, memory_order_relaxed);
+  // Large requests get a block of their own and leave the cursor alone.
+  if (bytes > blockSize / 4) return alignUp(newBlock(bytes + alignment), alignment);
+
+  uint64_t current = epoch.load(memory_order_relaxed);
+  Cursor* cursor = nullptr;
+  for (Cursor& c : cursors) {
+    if (c.epoch == current) cursor = &c;
+  }
+  if (!cursor) {
+    cursor = &cursors[nextCursor];
+    nextCursor = (nextCursor + 1) % CURSORS;
+    *cursor = Cursor{current, nullptr, nullptr};
+  }
+
+  char* p = cursor->next ? alignUp(cursor->next, alignment) : nullptr;
+  if (!p || p + bytes > cursor->end) {
+    char* block = newBlock(blockSize);
+    cursor->end = block + blockSize;
+    p = alignUp(block, alignment);
+  }
+  cursor->next = p + bytes;
+  return p;
+}
+
+ArenaScope::ArenaScope(Arena& arena) : previous(currentArena) {
+  currentArena = &arena;
+}
+
+ArenaScope::~ArenaScope() {
+  currentArena = previous;
+}
+
+Arena& ArenaScope::current() {
+  if (!currentArena) throw bad_alloc();
+  return *currentArena;
+}
@@ -0,0 +1,86 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+// Bump allocator for data that lives and dies together. Allocations are
+// carved out of large blocks and never freed one by one; release() frees all
+// blocks at once. Each thread bumps through a block of its own, so threads
+// only take the lock when they need a new block.
+class Arena : public std::pmr::memory_resource {
+public:
+  explicit Arena(size_t blockSize = 1 << 20);
+  ~Arena() override;
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  // Frees every block. Everything allocated from the arena is gone.
+  void release();
+
+  size_t blockCount() const;
+  size_t bytesReserved() const;
+  size_t allocationCount() const { return allocations.load(std::memory_order_relaxed); }
+
+protected:
+  void* do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void*, size_t, size_t) override {}
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+  char* newBlock(size_t size);
+
+  const size_t blockSize;
+  // Identifies the current set of blocks in per-thread cursors; changes on
+  // release() and is never reused by another arena.
+  std::atomic<uint64_t> epoch;
+  std::atomic<size_t> allocations{0};
+  mutable std::mutex lock;
+  std::vector<std::pair<char*, size_t>> blocks;
+};
+
+// Makes an arena the calling thread's current one for ArenaAllocator until
+// the scope ends. Scopes nest.
+class ArenaScope {
+public:
+  explicit ArenaScope(Arena& arena);
+  ~ArenaScope();
+
+  ArenaScope(const ArenaScope&) = delete;
+  ArenaScope& operator=(const ArenaScope&) = delete;
+
+  // The innermost arena installed on this thread; throws std::bad_alloc if
+  // there is none.
+  static Arena& current();
+
+private:
+  Arena* previous;
+};
+
+// Stateless allocator for containers that default-construct their allocators
+// (basic_json does): it allocates from ArenaScope::current() and never frees.
+// Containers using it must only grow inside a scope, and the arena must
+// outlive them.
+template <typename T>
+struct ArenaAllocator {
+  using value_type = T;
+
+  ArenaAllocator() noexcept = default;
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>&) noexcept {}
+
+  T* allocate(size_t n) { return static_cast<T*>(ArenaScope::current().allocate(n * sizeof(T), alignof(T))); }
+  void deallocate(T*, size_t) noexcept {}
+
+  template <typename U>
+  bool operator==(const ArenaAllocator<U>&) const noexcept { return true; }
+  template <typename U>
+  bool operator!=(const ArenaAllocator<U>&) const noexcept { return false; }
+};
+
+#endif
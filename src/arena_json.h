@@ -0,0 +1,40 @@
+#ifndef ARENA_JSON_H
+#define ARENA_JSON_H
+
+#include <cstdint>
+#include <new>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "arena.h"
+
+// nlohmann::json with every object, array, string and binary node allocated
+// from the current ArenaScope. Objects are sorted vectors, so each costs one
+// allocation and field lookups are binary searches; iteration order is the
+// same as with std::map.
+using arena_string = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+using arena_json = nlohmann::basic_json<nlohmann::sorted_map, std::vector, arena_string, bool, std::int64_t, std::uint64_t, double, ArenaAllocator,
+                                        nlohmann::adl_serializer, std::vector<std::uint8_t, ArenaAllocator<std::uint8_t>>>;
+
+// A DOM that lives in an arena of its own. The arena is current on the
+// constructing thread until the document is dropped, so the document must be
+// used on that thread only. Dropping it frees the arena's blocks without
+// visiting the tree: the root's destructor never runs.
+class ArenaDocument {
+public:
+  ArenaDocument() : scope(arena), value(new (arena.allocate(sizeof(arena_json), alignof(arena_json))) arena_json()) {}
+
+  ArenaDocument(const ArenaDocument&) = delete;
+  ArenaDocument& operator=(const ArenaDocument&) = delete;
+
+  arena_json& root() { return *value; }
+  const Arena& memory() const { return arena; }
+
+private:
+  Arena arena;
+  ArenaScope scope;
+  arena_json* value;
+};
+
+#endif
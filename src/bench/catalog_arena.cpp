@@ -0,0 +1,74 @@
+// Heap allocations and time of loading a large synthetic catalog and of
+// tearing it down again. Built once with the catalog arena and once with
+// CATALOG_ARENA=0, where record names and worker lists use the heap.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "../catalog.h"
+#include "counting_new.h"
+
+using namespace std;
+
+#ifndef CATALOG_ARENA
+#define CATALOG_ARENA 1
+#endif
+
+static void writeCatalog(const string& materialPath, const string& commodityPath, size_t commodities) {
+  const int materials = 100;
+  ofstream materialFile(materialPath);
+  materialFile << "{\n";
+  for (int m = 0; m < materials; m++) {
+    materialFile << "  \"Raw material " << m << "\": {\"inventory\": " << 1000 + m << ", \"production_capacity\": 5000, \"cost\": "
+                 << 10 + m % 7 << "}" << (m + 1 < materials ? ",\n" : "\n");
+  }
+  materialFile << "}\n";
+
+  ofstream commodityFile(commodityPath);
+  commodityFile << "[\n";
+  for (size_t c = 0; c < commodities; c++) {
+    int a = static_cast<int>(c % materials), b = static_cast<int>((c * 7 + 3) % materials);
+    if (a == b) b = (b + 1) % materials;
+    commodityFile << "{\"name\": \"Commodity number " << c << "\", \"materialNames\": [\"Raw material " << a << "\", \"Raw material " << b
+                  << "\"], \"usageRates\": {\"Raw material " << a << "\": 0.5, \"Raw material " << b
+                  << "\": 0.25}, \"laborRequired\": 10, \"laborAvailable\": 1000, \"demand\": " << c % 977 << ", \"priority\": " << c % 10 + 1
+                  << ", \"workers\": [";
+    for (int w = 0; w < 3; w++) {
+      commodityFile << (w ? ", " : "") << "{\"name\": \"Worker " << w << " of commodity " << c << "\", \"hoursWorked\": 40, \"wage\": 0}";
+    }
+    commodityFile << "]}" << (c + 1 < commodities ? ",\n" : "\n");
+  }
+  commodityFile << "]\n";
+}
+
+int main(int argc, char* argv[]) {
+  size_t commodities = argc > 1 ? strtoull(argv[1], nullptr, 10) : 500000;
+  string materialPath = "bench_materials.json";
+  string commodityPath = "bench_commodities.json";
+  writeCatalog(materialPath, commodityPath, commodities);
+
+  size_t startAllocations = allocations;
+  auto start = chrono::steady_clock::now();
+  loadData(true, materialPath, commodityPath);
+  double loadSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  size_t loadAllocations = allocations - startAllocations;
+  size_t arenaAllocations = catalogArena.allocationCount();
+  size_t arenaBlocks = catalogArena.blockCount();
+
+  size_t startFrees = frees;
+  start = chrono::steady_clock::now();
+  releaseCatalog();
+  double teardownSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+  remove(materialPath.c_str());
+  remove(commodityPath.c_str());
+
+  cout << commodities << " commodities, " << (CATALOG_ARENA ? "arena" : "heap") << " records" << endl;
+  cout << "  load: " << loadSeconds * 1e3 << " ms, " << loadAllocations << " heap allocations";
+  if (arenaAllocations) cout << " (" << arenaAllocations << " arena allocations in " << arenaBlocks << " blocks)";
+  cout << endl;
+  cout << "  teardown: " << teardownSeconds * 1e3 << " ms, " << frees - startFrees << " frees" << endl;
+  return 0;
+}
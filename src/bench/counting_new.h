@@ -0,0 +1,82 @@
+#ifndef COUNTING_NEW_H
+#define COUNTING_NEW_H
+
+// Replaces every form of the global operator new and delete with versions
+// that count allocations, frees and live bytes. Include it from exactly one
+// translation unit of a bench program.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<size_t> allocations{0};
+static std::atomic<size_t> frees{0};
+static std::atomic<size_t> liveBytes{0};
+static std::atomic<size_t> peakBytes{0};
+
+// Every block starts with a header as large as its alignment, whose last
+// bytes hold the requested size. Plain new uses the default alignment, so
+// each delete knows the header size from the form it is called with.
+static void* countedAllocate(size_t size, size_t alignment) noexcept {
+  alignment = std::max<size_t>(alignment, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+  size_t total = (alignment + size + alignment - 1) & ~(alignment - 1);
+  char* block = static_cast<char*>(std::aligned_alloc(alignment, total));
+  if (!block) return nullptr;
+  char* p = block + alignment;
+  reinterpret_cast<size_t*>(p)[-1] = size;
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  size_t live = liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+  size_t peak = peakBytes.load(std::memory_order_relaxed);
+  while (live > peak && !peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+  }
+  return p;
+}
+
+static void countedFree(void* p, size_t alignment) noexcept {
+  if (!p) return;
+  alignment = std::max<size_t>(alignment, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+  char* block = static_cast<char*>(p) - alignment;
+  frees.fetch_add(1, std::memory_order_relaxed);
+  liveBytes.fetch_sub(reinterpret_cast<size_t*>(p)[-1], std::memory_order_relaxed);
+  std::free(block);
+}
+
+static void* countedNew(size_t size, size_t alignment) {
+  void* p = countedAllocate(size, alignment);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+void* operator new(size_t size) { return countedNew(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new[](size_t size) { return countedNew(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new(size_t size, std::align_val_t alignment) { return countedNew(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment) { return countedNew(size, static_cast<size_t>(alignment)); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return countedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return countedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+  return countedAllocate(size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+  return countedAllocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* p) noexcept { countedFree(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete[](void* p) noexcept { countedFree(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete(void* p, size_t) noexcept { countedFree(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete[](void* p, size_t) noexcept { countedFree(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete(void* p, std::align_val_t alignment) noexcept { countedFree(p, static_cast<size_t>(alignment)); }
+void operator delete[](void* p, std::align_val_t alignment) noexcept { countedFree(p, static_cast<size_t>(alignment)); }
+void operator delete(void* p, size_t, std::align_val_t alignment) noexcept { countedFree(p, static_cast<size_t>(alignment)); }
+void operator delete[](void* p, size_t, std::align_val_t alignment) noexcept { countedFree(p, static_cast<size_t>(alignment)); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { countedFree(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { countedFree(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete(void* p, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+  countedFree(p, static_cast<size_t>(alignment));
+}
+void operator delete[](void* p, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+  countedFree(p, static_cast<size_t>(alignment));
+}
+
+#endif
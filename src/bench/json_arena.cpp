@@ -0,0 +1,67 @@
+// Heap allocations and time of parsing a large commodities document into a
+// DOM and dropping it again, with nlohmann::json and with an ArenaDocument.
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "../arena_json.h"
+#include "counting_new.h"
+
+using namespace std;
+
+static string makeDocument(size_t commodities) {
+  ostringstream text;
+  text << "[\n";
+  for (size_t c = 0; c < commodities; c++) {
+    text << "{\"name\": \"Commodity number " << c << "\", \"materialNames\": [\"Raw material " << c % 100 << "\", \"Raw material "
+         << (c * 7 + 3) % 100 << "\"], \"usageRates\": {\"Raw material " << c % 100 << "\": 0.5, \"Raw material " << (c * 7 + 3) % 100
+         << "\": 0.25}, \"laborRequired\": 10, \"laborAvailable\": 1000, \"demand\": " << c % 977 << ", \"priority\": " << c % 10 + 1
+         << ", \"workers\": [";
+    for (int w = 0; w < 3; w++) {
+      text << (w ? ", " : "") << "{\"name\": \"Worker " << w << " of commodity " << c << "\", \"hoursWorked\": 40, \"wage\": 0}";
+    }
+    text << "]}" << (c + 1 < commodities ? ",\n" : "\n");
+  }
+  text << "]\n";
+  return text.str();
+}
+
+static double seconds(chrono::steady_clock::time_point start) {
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+  size_t commodities = argc > 1 ? strtoull(argv[1], nullptr, 10) : 200000;
+  string text = makeDocument(commodities);
+  double checksum = 0;
+
+  size_t startAllocations = allocations;
+  auto start = chrono::steady_clock::now();
+  auto* heap = new nlohmann::json(nlohmann::json::parse(text));
+  double heapParse = seconds(start);
+  size_t heapAllocations = allocations - startAllocations;
+  checksum += (*heap)[commodities / 2].at("demand").get<double>();
+  start = chrono::steady_clock::now();
+  delete heap;
+  double heapDrop = seconds(start);
+
+  startAllocations = allocations;
+  start = chrono::steady_clock::now();
+  auto* arena = new ArenaDocument;
+  arena->root() = arena_json::parse(text);
+  double arenaParse = seconds(start);
+  size_t arenaAllocations = allocations - startAllocations;
+  size_t arenaBlocks = arena->memory().blockCount();
+  checksum += arena->root()[commodities / 2].at("demand").get<double>();
+  start = chrono::steady_clock::now();
+  delete arena;
+  double arenaDrop = seconds(start);
+
+  cout << commodities << " commodities, " << text.size() / (1024.0 * 1024.0) << " MiB of JSON" << endl;
+  cout << "  json:       parse " << heapParse * 1e3 << " ms, " << heapAllocations << " heap allocations, drop " << heapDrop * 1e3 << " ms"
+       << endl;
+  cout << "  arena_json: parse " << arenaParse * 1e3 << " ms, " << arenaAllocations << " heap allocations (" << arenaBlocks
+       << " blocks), drop " << arenaDrop * 1e3 << " ms" << endl;
+  return checksum == 0 ? 1 : 0;
+}
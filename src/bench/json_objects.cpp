@@ -0,0 +1,128 @@
+// Parse plus field access on a commodities document, the way a DOM loader
+// reads it, with std::map objects (nlohmann::json) and sorted vector objects
+// (nlohmann::sorted_json), and parse of one large materials object whose keys
+// are not in order.
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+using namespace std;
+
+static string makeDocument(size_t commodities) {
+  ostringstream text;
+  text << "[\n";
+  for (size_t c = 0; c < commodities; c++) {
+    size_t a = c % 100, b = (c * 7 + 3) % 100;
+    text << "{\"name\": \"Commodity number " << c << "\", \"materialNames\": [\"Raw material " << a << "\", \"Raw material " << b
+         << "\"], \"usageRates\": {\"Raw material " << a << "\": 0.5, \"Raw material " << b
+         << "\": 0.25}, \"laborRequired\": 10, \"laborAvailable\": 1000, \"demand\": " << c % 977 << ", \"priority\": " << c % 10 + 1
+         << ", \"workers\": [";
+    for (int w = 0; w < 3; w++) {
+      text << (w ? ", " : "") << "{\"name\": \"Worker " << w << " of commodity " << c << "\", \"hoursWorked\": 40, \"wage\": 0}";
+    }
+    text << "]}" << (c + 1 < commodities ? ",\n" : "\n");
+  }
+  text << "]\n";
+  return text.str();
+}
+
+static string makeMaterials(size_t materials) {
+  vector<size_t> order(materials);
+  iota(order.begin(), order.end(), 0);
+  shuffle(order.begin(), order.end(), mt19937(7));
+  ostringstream text;
+  text << "{\n";
+  for (size_t i = 0; i < materials; i++) {
+    text << "  \"Raw material " << order[i] << "\": {\"inventory\": " << order[i] % 1000
+         << ", \"production_capacity\": 5000, \"cost\": " << 10 + order[i] % 7 << "}" << (i + 1 < materials ? ",\n" : "\n");
+  }
+  text << "}\n";
+  return text.str();
+}
+
+template <typename Json>
+static double readFields(const Json& document) {
+  double sum = 0;
+  for (const auto& commodity : document) {
+    sum += commodity.at("name").template get_ref<const typename Json::string_t&>().size();
+    const auto& rates = commodity.at("usageRates");
+    for (const auto& material : commodity.at("materialNames")) sum += rates.at(material.template get_ref<const typename Json::string_t&>()).template get<double>();
+    sum += commodity.at("laborRequired").template get<int>() + commodity.at("laborAvailable").template get<int>();
+    sum += commodity.at("demand").template get<double>() + commodity.at("priority").template get<int>();
+    for (const auto& worker : commodity.at("workers")) {
+      sum += worker.at("name").template get_ref<const typename Json::string_t&>().size();
+      sum += worker.at("hoursWorked").template get<int>() + worker.at("wage").template get<double>();
+    }
+  }
+  return sum;
+}
+
+struct Timing {
+  double parse = 1e30;
+  double access = 1e30;
+  double sum = 0;
+};
+
+template <typename Json>
+static Timing measure(const string& text, int rounds) {
+  Timing timing;
+  for (int r = 0; r < rounds; r++) {
+    auto start = chrono::steady_clock::now();
+    Json document = Json::parse(text);
+    auto parsed = chrono::steady_clock::now();
+    timing.sum = readFields(document);
+    auto read = chrono::steady_clock::now();
+    timing.parse = min(timing.parse, chrono::duration<double>(parsed - start).count());
+    timing.access = min(timing.access, chrono::duration<double>(read - parsed).count());
+  }
+  return timing;
+}
+
+template <typename Json>
+static Timing measureMaterials(const string& text, int rounds) {
+  Timing timing;
+  for (int r = 0; r < rounds; r++) {
+    auto start = chrono::steady_clock::now();
+    Json document = Json::parse(text);
+    auto parsed = chrono::steady_clock::now();
+    timing.sum = 0;
+    for (const auto& material : document.items()) timing.sum += material.value().at("inventory").template get<double>();
+    auto read = chrono::steady_clock::now();
+    timing.parse = min(timing.parse, chrono::duration<double>(parsed - start).count());
+    timing.access = min(timing.access, chrono::duration<double>(read - parsed).count());
+  }
+  return timing;
+}
+
+static void report(const char* name, const Timing& t) {
+  cout << "  " << name << ": parse " << t.parse * 1e3 << " ms, field access " << t.access * 1e3 << " ms, total "
+       << (t.parse + t.access) * 1e3 << " ms" << endl;
+}
+
+int main(int argc, char* argv[]) {
+  size_t commodities = argc > 1 ? strtoull(argv[1], nullptr, 10) : 100000;
+  size_t materials = argc > 2 ? strtoull(argv[2], nullptr, 10) : 200000;
+  string text = makeDocument(commodities);
+  Timing tree = measure<nlohmann::json>(text, 3);
+  Timing flat = measure<nlohmann::sorted_json>(text, 3);
+
+  cout << commodities << " commodities, best of 3" << endl;
+  report("json (std::map)  ", tree);
+  report("sorted_json      ", flat);
+
+  string materialText = makeMaterials(materials);
+  Timing materialTree = measureMaterials<nlohmann::json>(materialText, 3);
+  Timing materialFlat = measureMaterials<nlohmann::sorted_json>(materialText, 3);
+
+  cout << materials << " materials in one object, keys shuffled, best of 3" << endl;
+  report("json (std::map)  ", materialTree);
+  report("sorted_json      ", materialFlat);
+  return tree.sum == flat.sum && materialTree.sum == materialFlat.sum ? 0 : 1;
+}
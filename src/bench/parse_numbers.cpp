@@ -0,0 +1,81 @@
+// Parses a numeric-heavy catalog held in memory and reports lexer throughput.
+// Built twice by `make bench`: with std::from_chars and with the strtod path
+// (JSON_USE_FROM_CHARS=0), so the two runs can be compared directly.
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <nlohmann/json.hpp>
+
+using namespace std;
+
+// Counts values without building a DOM, so the time is the lexer's.
+class NumberCounter : public nlohmann::json_sax<nlohmann::json> {
+public:
+  size_t numbers = 0;
+  double sum = 0.0;
+
+  bool null() override { return true; }
+  bool boolean(bool) override { return true; }
+  bool number_integer(number_integer_t val) override { numbers++; sum += static_cast<double>(val); return true; }
+  bool number_unsigned(number_unsigned_t val) override { numbers++; sum += static_cast<double>(val); return true; }
+  bool number_float(number_float_t val, const string_t&) override { numbers++; sum += val; return true; }
+  bool string(string_t&) override { return true; }
+  bool binary(binary_t&) override { return true; }
+  bool start_object(size_t) override { return true; }
+  bool end_object() override { return true; }
+  bool start_array(size_t) override { return true; }
+  bool end_array() override { return true; }
+  bool key(string_t&) override { return true; }
+  bool parse_error(size_t, const std::string&, const nlohmann::detail::exception&) override { return false; }
+};
+
+// A materials.json-shaped catalog: every material has an inventory, a
+// production capacity, a cost and usage rates of a few input materials.
+static std::string makeCatalog(int materials) {
+  mt19937_64 rng(42);
+  uniform_real_distribution<double> amount(0.0, 100000.0);
+  uniform_real_distribution<double> rate(0.0, 1.0);
+  std::string text = "{\n";
+  char number[32];
+  for (int m = 0; m < materials; m++) {
+    text += "    \"Material " + to_string(m) + "\": {\n";
+    snprintf(number, sizeof(number), "%.17g", amount(rng));
+    text += "        \"inventory\": " + std::string(number) + ",\n";
+    snprintf(number, sizeof(number), "%.6f", amount(rng));
+    text += "        \"production_capacity\": " + std::string(number) + ",\n";
+    snprintf(number, sizeof(number), "%.2f", amount(rng) / 100.0);
+    text += "        \"cost\": " + std::string(number) + ",\n";
+    text += "        \"inputs\": {";
+    for (int i = 0; i < 4; i++) {
+      snprintf(number, sizeof(number), "%.17g", rate(rng));
+      text += std::string(i ? ", " : "") + "\"Material " + to_string((m * 7 + i) % materials) + "\": " + number;
+    }
+    text += "}\n    }";
+    text += m + 1 < materials ? ",\n" : "\n";
+  }
+  text += "}\n";
+  return text;
+}
+
+int main(int argc, char* argv[]) {
+  int materials = argc > 1 ? atoi(argv[1]) : 200000;
+  int rounds = argc > 2 ? atoi(argv[2]) : 5;
+  std::string text = makeCatalog(materials);
+
+  double best = 1e300;
+  NumberCounter counter;
+  for (int r = 0; r < rounds; r++) {
+    counter = NumberCounter();
+    auto start = chrono::steady_clock::now();
+    nlohmann::json::sax_parse(text.data(), text.data() + text.size(), &counter);
+    best = min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+  }
+
+  cout << (JSON_USE_FROM_CHARS ? "from_chars" : "strtod") << ": " << counter.numbers << " numbers in "
+       << text.size() / 1e6 << " MB, best of " << rounds << ": " << best * 1e3 << " ms ("
+       << text.size() / 1e6 / best << " MB/s, " << counter.numbers / 1e6 / best << " M numbers/s), checksum "
+       << counter.sum << endl;
+  return 0;
+}
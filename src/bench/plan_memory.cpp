@@ -0,0 +1,66 @@
+// Heap use of building the plan order over a large synthetic catalog: as
+// indices into commodityDatabase (what planSequential does) and as the deep
+// copy of every record that the planner used to sort.
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../planner.h"
+#include "counting_new.h"
+
+using namespace std;
+
+struct Measurement {
+  size_t peak;
+  size_t allocations;
+  double seconds;
+};
+
+template <typename Build>
+static Measurement measure(Build build) {
+  size_t baseline = liveBytes;
+  peakBytes.store(baseline);
+  size_t startAllocations = allocations;
+  auto start = chrono::steady_clock::now();
+  build();
+  return Measurement{peakBytes - baseline, allocations - startAllocations,
+                     chrono::duration<double>(chrono::steady_clock::now() - start).count()};
+}
+
+static void report(const char* name, const Measurement& m) {
+  cout << "  " << name << ": peak +" << m.peak / (1024.0 * 1024.0) << " MiB, " << m.allocations << " allocations, "
+       << m.seconds * 1e3 << " ms" << endl;
+}
+
+int main(int argc, char* argv[]) {
+  size_t commodities = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+  for (int m = 0; m < 100; m++) internMaterial("Material " + to_string(m));
+  for (size_t c = 0; c < commodities; c++) {
+    Commodity commodity{pmr::string("Commodity " + to_string(c)), 10, 1000, static_cast<double>(c % 977), static_cast<int>(c % 10) + 1, {}};
+    for (int w = 0; w < 3; w++) commodity.workers.push_back(Worker{pmr::string("Worker " + to_string(w)), 8, 0.0});
+    commodityDatabase.push_back(std::move(commodity));
+    billOfMaterials.appendRow({static_cast<int>(c % 100), static_cast<int>((c * 7) % 100)}, {0.5, 0.25});
+  }
+  size_t catalog = liveBytes;
+
+  Measurement view = measure([] {
+    vector<int> order = priorityOrder();
+  });
+  Measurement copy = measure([] {
+    vector<pair<string, Commodity>> commodityVector;
+    commodityVector.reserve(commodityDatabase.size());
+    for (const Commodity& commodity : commodityDatabase) commodityVector.emplace_back(commodity.name, commodity);
+    sort(commodityVector.begin(), commodityVector.end(), [](const pair<string, Commodity>& a, const pair<string, Commodity>& b) {
+      if (a.second.priority == b.second.priority) return a.second.demand > b.second.demand;
+      return a.second.priority < b.second.priority;
+    });
+  });
+
+  cout << commodities << " commodities, catalog " << catalog / (1024.0 * 1024.0) << " MiB" << endl;
+  report("index order", view);
+  report("copied records", copy);
+  return 0;
+}
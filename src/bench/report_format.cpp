@@ -0,0 +1,55 @@
+// Writes a million-line report of prices through ReportSink to /dev/null, with
+// ostream << double and with formatNumber in both of its modes.
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "../number_format.h"
+#include "../report_sink.h"
+
+using namespace std;
+
+template <typename Write>
+static double timeReport(const vector<string>& names, const vector<double>& values, Write write) {
+  ReportSink sink;
+  if (!sink.open("/dev/null")) {
+    cerr << "Cannot open /dev/null" << endl;
+    exit(EXIT_FAILURE);
+  }
+  ostream out(&sink);
+  auto start = chrono::steady_clock::now();
+  for (size_t i = 0; i < values.size(); i++) {
+    out << " Price for " << names[i % names.size()] << ": ";
+    write(out, values[i]);
+    out << '\n';
+  }
+  sink.close();
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+  size_t lines = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+  mt19937_64 rng(7);
+  uniform_real_distribution<double> cost(1.0, 100000.0);
+  uniform_int_distribution<int> demand(1, 1000);
+  vector<string> names;
+  for (int c = 0; c < 1000; c++) names.push_back("Commodity " + to_string(c));
+  vector<double> values(lines);
+  for (double& value : values) value = cost(rng) / demand(rng);
+
+  double stream = timeReport(names, values, [](ostream& out, double value) { out << value; });
+  double shortest = timeReport(names, values, [](ostream& out, double value) { out << FormattedNumber{value, 0}; });
+  double fixed = timeReport(names, values, [](ostream& out, double value) { out << FormattedNumber{value, 6}; });
+  double exactStream = timeReport(names, values, [](ostream& out, double value) {
+    out.precision(17);
+    out << value;
+  });
+
+  cout << lines << " lines" << endl;
+  cout << "  ostream << double (6 digits):   " << stream * 1e3 << " ms" << endl;
+  cout << "  ostream << double (17 digits):  " << exactStream * 1e3 << " ms" << endl;
+  cout << "  formatNumber shortest:          " << shortest * 1e3 << " ms" << endl;
+  cout << "  formatNumber 6 digits:          " << fixed * 1e3 << " ms" << endl;
+  return 0;
+}
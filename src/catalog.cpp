@@ -0,0 +1,863 @@
+#include "catalog.h"
+#include "arena_json.h"
+#include "mapped_file.h"
+
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <tuple>
+#include <functional>
+#include <iterator>
+#include <thread>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+using namespace std;
+
+#ifndef CATALOG_ARENA
+#define CATALOG_ARENA 1
+#endif
+
+// Defined before the databases so that it outlives the records it backs.
+Arena catalogArena;
+
+vector<Materials> materialDatabase;
+vector<Commodity> commodityDatabase;
+BillOfMaterials billOfMaterials;
+BillOfMaterials materialInputs;
+
+// Name lookups are only needed while loading and when applying updates by name.
+static unordered_map<string, int> materialIndex;
+static unordered_map<string, int> commodityIndex;
+
+// (material, input, amount) triples read from materials.json. Inputs may name
+// materials defined later in the file, so the matrix is built once all
+// material IDs are known.
+static vector<tuple<int, int, double>> materialInputEntries;
+
+// Link state while loading: which material IDs materials.json defines (the
+// rest are placeholders interned for references), which commodity IDs the
+// commodities file has defined so far, and reference problems found so far,
+// reported together once everything is read.
+static vector<char> materialDefined;
+static vector<char> commodityDefined;
+static vector<string> linkErrors;
+
+// Catalogs restored from a snapshot start without name indices; they are
+// built on first use.
+static void syncNameIndex() {
+  if (materialIndex.size() < materialDatabase.size()) {
+    materialIndex.clear();
+    materialIndex.reserve(materialDatabase.size());
+    for (size_t m = 0; m < materialDatabase.size(); m++) materialIndex.emplace(materialDatabase[m].name, static_cast<int>(m));
+  }
+  if (commodityIndex.size() < commodityDatabase.size()) {
+    commodityIndex.clear();
+    commodityIndex.reserve(commodityDatabase.size());
+    for (size_t c = 0; c < commodityDatabase.size(); c++) commodityIndex.emplace(commodityDatabase[c].name, static_cast<int>(c));
+  }
+}
+
+CatalogAllocationScope::CatalogAllocationScope() : previous(pmr::get_default_resource()) {
+#if CATALOG_ARENA
+  pmr::set_default_resource(&catalogArena);
+#endif
+}
+
+CatalogAllocationScope::~CatalogAllocationScope() {
+  pmr::set_default_resource(previous);
+}
+
+int internMaterial(const string& name) {
+  syncNameIndex();
+  auto it = materialIndex.find(name);
+  if (it != materialIndex.end()) return it->second;
+  int id = static_cast<int>(materialDatabase.size());
+  materialDatabase.push_back(Materials{pmr::string(name), 0.0, 0.0, 0.0f});
+  materialIndex.emplace(name, id);
+  return id;
+}
+
+void BillOfMaterials::appendRow(const vector<int>& ids, const vector<double>& rates) {
+  materialIds.insert(materialIds.size(), ids.begin(), ids.end());
+  usageRates.insert(usageRates.size(), rates.begin(), rates.end());
+  rowStart.push_back(materialIds.size());
+}
+
+void BillOfMaterials::replaceRow(int commodityId, const vector<int>& ids, const vector<double>& rates) {
+  size_t begin = rowBegin(commodityId);
+  size_t end = rowEnd(commodityId);
+  materialIds.erase(begin, end);
+  materialIds.insert(begin, ids.begin(), ids.end());
+  usageRates.erase(begin, end);
+  usageRates.insert(begin, rates.begin(), rates.end());
+  ptrdiff_t shift = static_cast<ptrdiff_t>(ids.size()) - static_cast<ptrdiff_t>(end - begin);
+  size_t* starts = rowStart.mutableData();
+  for (size_t r = commodityId + 1; r < rowStart.size(); r++) starts[r] += shift;
+}
+
+void BillOfMaterials::multiplyTransposed(const vector<double>& x, vector<double>& y) const {
+  y.assign(materialDatabase.size(), 0.0);
+  for (size_t r = 0; r < rows(); r++) {
+    for (size_t e = rowStart[r]; e < rowStart[r + 1]; e++) {
+      y[materialIds[e]] += usageRates[e] * x[r];
+    }
+  }
+}
+
+// A commodity as it appears in commodities.json, before its material names are
+// resolved to IDs.
+struct CommodityRecord {
+  Commodity commodity;
+  vector<string> materialNames;
+  map<string, double> usageRates;
+};
+
+// Fills Commodity records directly from SAX events so that loading never holds
+// more than the record currently being parsed, instead of a DOM of the file.
+class CommoditySaxHandler : public nlohmann::json_sax<nlohmann::json> {
+public:
+  // With elementsOnly set the handler expects a sequence of commodity objects
+  // as if already inside the top-level array, for parsing single elements.
+  explicit CommoditySaxHandler(function<void(CommodityRecord&)> onCommodity, bool elementsOnly = false)
+    : onCommodity(std::move(onCommodity)), depth(elementsOnly ? 1 : 0) {}
+
+  const std::string& errorMessage() const { return error; }
+  bool isParseError() const { return parseFailed; }
+
+  bool null() override { return scalar(nullptr, nullptr, "null"); }
+  bool boolean(bool) override { return scalar(nullptr, nullptr, "boolean"); }
+  bool number_integer(number_integer_t val) override { double d = static_cast<double>(val); return scalar(&d, nullptr, "number"); }
+  bool number_unsigned(number_unsigned_t val) override { double d = static_cast<double>(val); return scalar(&d, nullptr, "number"); }
+  bool number_float(number_float_t val, const string_t&) override { double d = val; return scalar(&d, nullptr, "number"); }
+  bool string(string_t& val) override { return scalar(nullptr, &val, "string"); }
+  bool binary(binary_t&) override { return scalar(nullptr, nullptr, "binary"); }
+
+  bool start_object(size_t) override {
+    if (skipDepth > 0) { skipDepth++; return true; }
+    switch (depth) {
+      case 0:
+        depth = 1;
+        return true;
+      case 1:
+        current = CommodityRecord();
+        seen = 0;
+        field = Field::None;
+        depth = 2;
+        return true;
+      case 2:
+        if (field == Field::UsageRates) { depth = 3; return true; }
+        if (field == Field::Ignored) { skipDepth = 1; return true; }
+        return typeError(fieldName(field), "object");
+      case 3:
+        if (field == Field::Workers) {
+          worker = Worker();
+          workerSeen = 0;
+          workerField = WorkerField::None;
+          depth = 4;
+          return true;
+        }
+        return typeError(fieldName(field), "object");
+      default:
+        if (workerField == WorkerField::Ignored) { skipDepth = 1; return true; }
+        return typeError(workerFieldName(workerField), "object");
+    }
+  }
+
+  bool end_object() override {
+    if (skipDepth > 0) { skipDepth--; return true; }
+    switch (depth) {
+      case 1:
+        depth = 0;
+        return true;
+      case 2:
+        for (int f = 0; f < FIELD_COUNT; f++) {
+          if (!(seen & (1u << f))) return keyError(fieldName(static_cast<Field>(f)));
+        }
+        onCommodity(current);
+        depth = 1;
+        return true;
+      case 3:
+        depth = 2;
+        return true;
+      default:
+        for (int f = 0; f < WORKER_FIELD_COUNT; f++) {
+          if (!(workerSeen & (1u << f))) return keyError(workerFieldName(static_cast<WorkerField>(f)));
+        }
+        current.commodity.workers.push_back(worker);
+        depth = 3;
+        return true;
+    }
+  }
+
+  bool start_array(size_t) override {
+    if (skipDepth > 0) { skipDepth++; return true; }
+    switch (depth) {
+      case 0:
+        depth = 1;
+        return true;
+      case 1:
+        return typeError("commodity", "array");
+      case 2:
+        if (field == Field::MaterialNames || field == Field::Workers) { depth = 3; return true; }
+        if (field == Field::Ignored) { skipDepth = 1; return true; }
+        return typeError(fieldName(field), "array");
+      case 3:
+        return typeError(fieldName(field), "array");
+      default:
+        if (workerField == WorkerField::Ignored) { skipDepth = 1; return true; }
+        return typeError(workerFieldName(workerField), "array");
+    }
+  }
+
+  bool end_array() override {
+    if (skipDepth > 0) { skipDepth--; return true; }
+    depth = depth == 3 ? 2 : 0;
+    return true;
+  }
+
+  bool key(string_t& val) override {
+    if (skipDepth > 0) return true;
+    switch (depth) {
+      case 2:
+        field = lookupField(val);
+        if (field != Field::Ignored) seen |= 1u << static_cast<int>(field);
+        return true;
+      case 3:
+        rateKey = std::move(val);
+        return true;
+      case 4:
+        workerField = lookupWorkerField(val);
+        if (workerField != WorkerField::Ignored) workerSeen |= 1u << static_cast<int>(workerField);
+        return true;
+      default:
+        return true;
+    }
+  }
+
+  bool parse_error(size_t, const std::string&, const nlohmann::detail::exception& ex) override {
+    error = ex.what();
+    parseFailed = true;
+    return false;
+  }
+
+private:
+  enum class Field { Name, MaterialNames, UsageRates, LaborRequired, LaborAvailable, Demand, Priority, Workers, Ignored, None };
+  enum class WorkerField { Name, HoursWorked, Wage, Ignored, None };
+  static const int FIELD_COUNT = static_cast<int>(Field::Ignored);
+  static const int WORKER_FIELD_COUNT = static_cast<int>(WorkerField::Ignored);
+
+  static Field lookupField(const std::string& key) {
+    for (int f = 0; f < FIELD_COUNT; f++) {
+      if (key == fieldName(static_cast<Field>(f))) return static_cast<Field>(f);
+    }
+    return Field::Ignored;
+  }
+
+  static WorkerField lookupWorkerField(const std::string& key) {
+    for (int f = 0; f < WORKER_FIELD_COUNT; f++) {
+      if (key == workerFieldName(static_cast<WorkerField>(f))) return static_cast<WorkerField>(f);
+    }
+    return WorkerField::Ignored;
+  }
+
+  static const char* fieldName(Field f) {
+    static const char* names[] = {"name", "materialNames", "usageRates", "laborRequired", "laborAvailable", "demand", "priority", "workers"};
+    return f < Field::Ignored ? names[static_cast<int>(f)] : "commodity";
+  }
+
+  static const char* workerFieldName(WorkerField f) {
+    static const char* names[] = {"name", "hoursWorked", "wage"};
+    return f < WorkerField::Ignored ? names[static_cast<int>(f)] : "worker";
+  }
+
+  // Stores one scalar value; exactly one of number/text is set for numbers and strings.
+  bool scalar(const double* number, std::string* text, const char* type) {
+    if (skipDepth > 0) return true;
+    switch (depth) {
+      case 2:
+        switch (field) {
+          case Field::Name:
+            if (!text) return typeError("name", type);
+            current.commodity.name = std::move(*text);
+            return true;
+          case Field::LaborRequired:
+            if (!number) return typeError("laborRequired", type);
+            current.commodity.laborRequired = static_cast<int>(*number);
+            return true;
+          case Field::LaborAvailable:
+            if (!number) return typeError("laborAvailable", type);
+            current.commodity.laborAvailable = static_cast<int>(*number);
+            return true;
+          case Field::Demand:
+            if (!number) return typeError("demand", type);
+            current.commodity.demand = *number;
+            return true;
+          case Field::Priority:
+            if (!number) return typeError("priority", type);
+            current.commodity.priority = static_cast<int>(*number);
+            return true;
+          case Field::Ignored:
+            return true;
+          default:
+            return typeError(fieldName(field), type);
+        }
+      case 3:
+        if (field == Field::MaterialNames) {
+          if (!text) return typeError("materialNames", type);
+          current.materialNames.push_back(std::move(*text));
+          return true;
+        }
+        if (field == Field::UsageRates) {
+          if (!number) return typeError("usageRates", type);
+          current.usageRates[rateKey] = *number;
+          return true;
+        }
+        return typeError("workers", type);
+      case 4:
+        switch (workerField) {
+          case WorkerField::Name:
+            if (!text) return typeError("name", type);
+            worker.name = std::move(*text);
+            return true;
+          case WorkerField::HoursWorked:
+            if (!number) return typeError("hoursWorked", type);
+            worker.hoursWorked = static_cast<int>(*number);
+            return true;
+          case WorkerField::Wage:
+            if (!number) return typeError("wage", type);
+            worker.wage = *number;
+            return true;
+          default:
+            return true;
+        }
+      default:
+        return typeError(depth == 0 ? "commodities" : "commodity", type);
+    }
+  }
+
+  bool keyError(const char* key) {
+    error = "Json key error in commodities.json: key '" + std::string(key) + "' not found";
+    return false;
+  }
+
+  bool typeError(const char* key, const char* type) {
+    error = "Json type error in commodities.json: unexpected " + std::string(type) + " for '" + key + "'";
+    return false;
+  }
+
+  function<void(CommodityRecord&)> onCommodity;
+  CommodityRecord current;
+  Worker worker;
+  std::string rateKey;
+  std::string error;
+  Field field = Field::None;
+  WorkerField workerField = WorkerField::None;
+  unsigned seen = 0;
+  unsigned workerSeen = 0;
+  int depth = 0;
+  int skipDepth = 0;
+  bool parseFailed = false;
+};
+
+int findMaterial(const string& name) {
+  syncNameIndex();
+  auto it = materialIndex.find(name);
+  return it == materialIndex.end() ? -1 : it->second;
+}
+
+int findCommodity(const string& name) {
+  syncNameIndex();
+  auto it = commodityIndex.find(name);
+  return it == commodityIndex.end() ? -1 : it->second;
+}
+
+// Stores a commodity whose materials are resolved, replacing any commodity of
+// the same name from an earlier load. A name the file itself repeats is a
+// link error.
+static void storeCommodity(Commodity& c, const vector<int>& ids, const vector<double>& rates) {
+  string name(c.name);
+  auto it = commodityIndex.find(name);
+  int id;
+  if (it != commodityIndex.end()) {
+    id = it->second;
+    if (static_cast<size_t>(id) < commodityDefined.size() && commodityDefined[id]) {
+      linkErrors.push_back("commodity '" + name + "' is defined more than once");
+    }
+    commodityDatabase[id] = std::move(c);
+    billOfMaterials.replaceRow(id, ids, rates);
+  } else {
+    id = static_cast<int>(commodityDatabase.size());
+    commodityIndex.emplace(std::move(name), id);
+    commodityDatabase.push_back(std::move(c));
+    billOfMaterials.appendRow(ids, rates);
+  }
+  if (commodityDefined.size() <= static_cast<size_t>(id)) commodityDefined.resize(id + 1, 0);
+  commodityDefined[id] = 1;
+}
+
+// Resolves the record's material names and stores it.
+static void addCommodity(CommodityRecord& record) {
+  Commodity& c = record.commodity;
+  vector<int> ids;
+  vector<double> rates;
+  ids.reserve(record.materialNames.size());
+  rates.reserve(record.materialNames.size());
+  for (const string& materialName : record.materialNames) {
+    auto rate = record.usageRates.find(materialName);
+    if (rate == record.usageRates.end()) {
+      linkErrors.push_back("no usage rate for '" + materialName + "' in '" + string(c.name) + "'");
+    }
+    ids.push_back(internMaterial(materialName));
+    rates.push_back(rate == record.usageRates.end() ? 0.0 : rate->second);
+  }
+  for (const auto& rate : record.usageRates) {
+    if (find(record.materialNames.begin(), record.materialNames.end(), rate.first) == record.materialNames.end()) {
+      linkErrors.push_back("usage rate for '" + rate.first + "' in '" + string(c.name) + "' names no entry of its materialNames");
+    }
+  }
+  storeCommodity(c, ids, rates);
+}
+
+using InputFormat = nlohmann::json::input_format_t;
+
+static bool hasExtension(const string& path, const char* extension) {
+  size_t n = strlen(extension);
+  return path.size() >= n && path.compare(path.size() - n, n, extension) == 0;
+}
+
+bool parseCatalogFormat(const string& name, CatalogFormat& format) {
+    static const pair<const char*, CatalogFormat> names[] = {
+        {"json", CatalogFormat::Json},     {"cbor", CatalogFormat::Cbor},     {"msgpack", CatalogFormat::MessagePack},
+        {"bson", CatalogFormat::Bson},     {"ubjson", CatalogFormat::Ubjson}, {"bjdata", CatalogFormat::BJData},
+    };
+    for (const auto& entry : names) {
+        if (name == entry.first) {
+            format = entry.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Picks the input format: the one given, else from the file extension, else
+// from openings no other format shares. MessagePack, CBOR and BSON type bytes
+// overlap (0x80-0x9f is a MessagePack map or array and a CBOR negative
+// integer or byte string, and a BSON length can be any bytes), and UBJSON and
+// BJData open with '{' or '[' like text JSON, so those need an extension or
+// the format named. Exits when the format cannot be told.
+static InputFormat detectFormat(const string& path, const unsigned char* head, size_t headSize, CatalogFormat given) {
+    switch (given) {
+        case CatalogFormat::Json: return InputFormat::json;
+        case CatalogFormat::Cbor: return InputFormat::cbor;
+        case CatalogFormat::MessagePack: return InputFormat::msgpack;
+        case CatalogFormat::Bson: return InputFormat::bson;
+        case CatalogFormat::Ubjson: return InputFormat::ubjson;
+        case CatalogFormat::BJData: return InputFormat::bjdata;
+        case CatalogFormat::Detect: break;
+    }
+    if (hasExtension(path, ".json")) return InputFormat::json;
+    if (hasExtension(path, ".cbor")) return InputFormat::cbor;
+    if (hasExtension(path, ".msgpack") || hasExtension(path, ".mpk")) return InputFormat::msgpack;
+    if (hasExtension(path, ".bson")) return InputFormat::bson;
+    if (hasExtension(path, ".ubj") || hasExtension(path, ".ubjson")) return InputFormat::ubjson;
+    if (hasExtension(path, ".bjdata") || hasExtension(path, ".bjd")) return InputFormat::bjdata;
+
+    if (headSize >= 3 && head[0] == 0xd9 && head[1] == 0xd9 && head[2] == 0xf7) return InputFormat::cbor;
+    // Empty files are left to the JSON parser to report; 0xef opens a UTF-8
+    // byte order mark, which the parser skips.
+    if (headSize == 0 || head[0] == '{' || head[0] == '[' || head[0] == ' ' || head[0] == '\t' || head[0] == '\n' ||
+        head[0] == '\r' || (headSize >= 3 && head[0] == 0xef && head[1] == 0xbb && head[2] == 0xbf)) {
+        return InputFormat::json;
+    }
+    cerr << "Cannot tell the format of " << path << ": give it a .json, .cbor, .msgpack, .bson, .ubj or .bjdata extension"
+         << " or name the format with --input-format" << '\n';
+    exit(EXIT_FAILURE);
+}
+
+template <typename... Input>
+static void loadCommodities(InputFormat format, Input&&... commodityInput) {
+    CommoditySaxHandler handler(addCommodity);
+    if (!nlohmann::json::sax_parse(std::forward<Input>(commodityInput)..., &handler, format)) {
+        if (handler.isParseError()) {
+            cerr << "Parse error: " << handler.errorMessage() << '\n';
+        } else {
+            cerr << handler.errorMessage() << '\n';
+        }
+        exit(EXIT_FAILURE);
+    }
+}
+
+template <typename Json, typename... Input>
+static Json parseDocument(InputFormat format, Input&&... input) {
+    switch (format) {
+        case InputFormat::cbor: return Json::from_cbor(std::forward<Input>(input)...);
+        case InputFormat::msgpack: return Json::from_msgpack(std::forward<Input>(input)...);
+        case InputFormat::ubjson: return Json::from_ubjson(std::forward<Input>(input)...);
+        case InputFormat::bson: return Json::from_bson(std::forward<Input>(input)...);
+        case InputFormat::bjdata: return Json::from_bjdata(std::forward<Input>(input)...);
+        default: return Json::parse(std::forward<Input>(input)...);
+    }
+}
+
+// A numeric field of a material's record; a missing or non-numeric one is
+// reported with the material's name and ends loading.
+template <typename T>
+static T materialNumber(const arena_json& fields, const string& material, const char* key) {
+    auto field = fields.find(key);
+    if (field == fields.end()) {
+        cerr << "Json key error in materials.json: key '" << key << "' not found for material '" << material << "'" << '\n';
+        exit(EXIT_FAILURE);
+    }
+    if (!field->is_number()) {
+        cerr << "Json type error in materials.json: unexpected " << field->type_name() << " for '" << key << "' of material '"
+             << material << "'" << '\n';
+        exit(EXIT_FAILURE);
+    }
+    return field->get<T>();
+}
+
+template <typename... Input>
+static void loadMaterials(InputFormat format, Input&&... materialInput) {
+    // The document is only read once, so it is built in an arena and dropped
+    // without a walk over its nodes.
+    ArenaDocument document;
+    arena_json& materialJson = document.root();
+
+    try {
+        materialJson = parseDocument<arena_json>(format, std::forward<Input>(materialInput)...);
+    } catch (nlohmann::json::parse_error &e) {
+        cerr << "Parse error: " << e.what() << '\n';
+        exit(EXIT_FAILURE);
+    }
+
+    if (!materialJson.is_object()) {
+        cerr << "Json type error in materials.json: unexpected " << materialJson.type_name() << " for 'materials'" << '\n';
+        exit(EXIT_FAILURE);
+    }
+    for (const auto &item : materialJson.items()) {
+        string name(item.key());
+        const arena_json& fields = item.value();
+        if (!fields.is_object()) {
+            cerr << "Json type error in materials.json: unexpected " << fields.type_name() << " for material '" << name << "'" << '\n';
+            exit(EXIT_FAILURE);
+        }
+        Materials m;
+        m.name = name;
+        m.inventory = materialNumber<double>(fields, name, "inventory");
+        m.production_capacity = materialNumber<double>(fields, name, "production_capacity");
+        m.cost = materialNumber<float>(fields, name, "cost");
+        int id;
+        auto it = materialIndex.find(name);
+        if (it != materialIndex.end()) {
+            id = it->second;
+            materialDatabase[id] = m;
+        } else {
+            id = static_cast<int>(materialDatabase.size());
+            materialIndex[name] = id;
+            materialDatabase.push_back(m);
+        }
+        if (materialDefined.size() <= static_cast<size_t>(id)) materialDefined.resize(id + 1, 0);
+        materialDefined[id] = 1;
+
+        auto inputs = fields.find("inputs");
+        if (inputs != fields.end()) {
+            if (!inputs->is_object()) {
+                cerr << "Json type error in materials.json: unexpected " << inputs->type_name() << " for 'inputs' of material '"
+                     << name << "'" << '\n';
+                exit(EXIT_FAILURE);
+            }
+            for (const auto &input : inputs->items()) {
+                string inputName(input.key());
+                materialInputEntries.emplace_back(id, internMaterial(inputName), materialNumber<double>(*inputs, name, inputName.c_str()));
+            }
+        }
+    }
+}
+
+static void buildMaterialInputs() {
+    stable_sort(materialInputEntries.begin(), materialInputEntries.end(),
+                [](const tuple<int, int, double>& a, const tuple<int, int, double>& b) { return get<0>(a) < get<0>(b); });
+    vector<int> ids;
+    vector<double> amounts;
+    size_t next = 0;
+    for (size_t m = 0; m < materialDatabase.size(); m++) {
+        ids.clear();
+        amounts.clear();
+        for (; next < materialInputEntries.size() && get<0>(materialInputEntries[next]) == static_cast<int>(m); next++) {
+            ids.push_back(get<1>(materialInputEntries[next]));
+            amounts.push_back(get<2>(materialInputEntries[next]));
+        }
+        materialInputs.appendRow(ids, amounts);
+    }
+    materialInputEntries.clear();
+}
+
+// Finds the top-level elements of a JSON array without parsing them: only
+// strings and bracket depth are tracked. Returns false if the text is not a
+// single array, leaving malformed input to the full parser to report.
+static bool findArrayElements(const char* first, const char* last, vector<pair<const char*, const char*>>& elements) {
+    auto isSpace = [](char ch) { return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r'; };
+    const char* p = first;
+    while (p < last && isSpace(*p)) p++;
+    if (p == last || *p != '[') return false;
+    const char* start = ++p;
+    int depth = 1;
+    while (p < last) {
+        char ch = *p;
+        if (ch == '"') {
+            // Skip to the closing quote, stepping over escaped characters.
+            p++;
+            for (;;) {
+                p = static_cast<const char*>(memchr(p, '"', last - p));
+                if (!p) return false;
+                const char* q = p;
+                while (q[-1] == '\\') q--;
+                if ((p - q) % 2 == 0) break;
+                p++;
+            }
+        } else if (ch == '{' || ch == '[') {
+            depth++;
+        } else if (ch == '}' || ch == ']') {
+            if (--depth == 0) {
+                const char* end = p;
+                while (start < end && isSpace(*start)) start++;
+                if (start < end || !elements.empty()) elements.emplace_back(start, end);
+                p++;
+                break;
+            }
+        } else if (ch == ',' && depth == 1) {
+            elements.emplace_back(start, p);
+            start = p + 1;
+        }
+        p++;
+    }
+    if (depth != 0) return false;
+    while (p < last && isSpace(*p)) p++;
+    return p == last;
+}
+
+// A commodity parsed on a worker thread, with its materials resolved against
+// materials.json. Materials that file does not define stay -1 until the merge
+// interns them, so IDs come out as the serial loader assigns them.
+struct ParsedCommodity {
+    CommodityRecord record;
+    vector<int> ids;
+    vector<double> rates;
+};
+
+static unsigned lastCommodityThreads = 1;
+
+unsigned commodityLoadThreads() {
+    return lastCommodityThreads;
+}
+
+// Parses a text JSON commodity array on several threads: a pre-scan splits
+// the array into elements, each thread parses and resolves a contiguous run
+// of them, and the runs are stored in document order. Returns false without
+// touching the catalog if the text is not an array or any element is
+// invalid, so that the serial loader can report the error.
+static bool loadCommoditiesParallel(const char* first, const char* last, unsigned threads) {
+    vector<pair<const char*, const char*>> elements;
+    if (!findArrayElements(first, last, elements)) return false;
+    threads = static_cast<unsigned>(min<size_t>(threads, elements.size()));
+    if (threads < 2) return false;
+
+    syncNameIndex();
+
+    // Chunks hold contiguous elements of roughly equal size in bytes.
+    vector<size_t> chunkStart{0};
+    size_t total = static_cast<size_t>(last - first);
+    for (size_t e = 0; e < elements.size() && chunkStart.size() < threads; e++) {
+        if (static_cast<size_t>(elements[e].first - first) >= total * chunkStart.size() / threads && e > chunkStart.back()) {
+            chunkStart.push_back(e);
+        }
+    }
+    chunkStart.push_back(elements.size());
+    size_t chunks = chunkStart.size() - 1;
+
+    vector<vector<ParsedCommodity>> parsed(chunks);
+    vector<char> failed(chunks, 0);
+    auto parseChunk = [&](size_t chunk) {
+        vector<ParsedCommodity>& out = parsed[chunk];
+        bool ok = true;
+        CommoditySaxHandler handler([&](CommodityRecord& record) {
+            ParsedCommodity commodity;
+            commodity.ids.reserve(record.materialNames.size());
+            commodity.rates.reserve(record.materialNames.size());
+            for (const string& materialName : record.materialNames) {
+                auto rate = record.usageRates.find(materialName);
+                if (rate == record.usageRates.end()) { ok = false; return; }
+                auto id = materialIndex.find(materialName);
+                commodity.ids.push_back(id == materialIndex.end() ? -1 : id->second);
+                commodity.rates.push_back(rate->second);
+            }
+            for (const auto& rate : record.usageRates) {
+                if (find(record.materialNames.begin(), record.materialNames.end(), rate.first) == record.materialNames.end()) { ok = false; return; }
+            }
+            commodity.record = std::move(record);
+            out.push_back(std::move(commodity));
+        }, true);
+        for (size_t e = chunkStart[chunk]; e < chunkStart[chunk + 1] && ok; e++) {
+            if (!nlohmann::json::sax_parse(elements[e].first, elements[e].second, &handler)) ok = false;
+        }
+        failed[chunk] = !ok;
+    };
+
+    vector<thread> workers;
+    for (size_t chunk = 1; chunk < chunks; chunk++) workers.emplace_back(parseChunk, chunk);
+    parseChunk(0);
+    for (thread& worker : workers) worker.join();
+    if (find(failed.begin(), failed.end(), 1) != failed.end()) return false;
+
+    for (vector<ParsedCommodity>& chunk : parsed) {
+        for (ParsedCommodity& commodity : chunk) {
+            for (size_t k = 0; k < commodity.ids.size(); k++) {
+                if (commodity.ids[k] < 0) commodity.ids[k] = internMaterial(commodity.record.materialNames[k]);
+            }
+            storeCommodity(commodity.record.commodity, commodity.ids, commodity.rates);
+        }
+    }
+    lastCommodityThreads = static_cast<unsigned>(chunks);
+    return true;
+}
+
+// Reports every reference to a material that materials.json does not define,
+// along with the usage rate and duplicate name problems collected while
+// loading, and exits if there are any, releasing the catalog first so that
+// nothing half-linked is left. With allowUndefined, undefined materials are
+// kept as empty placeholder records and only reported as warnings.
+static void linkCatalog(const string& materialPath, const string& commodityPath, bool allowUndefined) {
+    materialDefined.resize(materialDatabase.size(), 0);
+    vector<string> undefined;
+    for (size_t c = 0; c < commodityDatabase.size(); c++) {
+        for (size_t e = billOfMaterials.rowBegin(static_cast<int>(c)); e < billOfMaterials.rowEnd(static_cast<int>(c)); e++) {
+            int m = billOfMaterials.materialIds[e];
+            if (!materialDefined[m]) {
+                undefined.push_back("'" + string(commodityDatabase[c].name) + "' uses material '" + string(materialDatabase[m].name) + "', which " + materialPath + " does not define");
+            }
+        }
+    }
+    for (size_t m = 0; m < materialInputs.rows(); m++) {
+        for (size_t e = materialInputs.rowBegin(static_cast<int>(m)); e < materialInputs.rowEnd(static_cast<int>(m)); e++) {
+            int input = materialInputs.materialIds[e];
+            if (!materialDefined[input]) {
+                undefined.push_back("'" + string(materialDatabase[m].name) + "' lists input '" + string(materialDatabase[input].name) + "', which " + materialPath + " does not define");
+            }
+        }
+    }
+    materialDefined.clear();
+    commodityDefined.clear();
+
+    if (allowUndefined) {
+        for (const string& warning : undefined) cerr << "Warning: " << warning << '\n';
+    } else {
+        linkErrors.insert(linkErrors.end(), undefined.begin(), undefined.end());
+    }
+    if (!linkErrors.empty()) {
+        cerr << "Link errors in " << materialPath << " and " << commodityPath << " (" << linkErrors.size() << "):" << '\n';
+        for (const string& error : linkErrors) cerr << "  " << error << '\n';
+        linkErrors.clear();
+        releaseCatalog();
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Loads commodities from text already in memory, on several threads when it
+// is a JSON array.
+static void loadCommodityText(InputFormat format, const char* first, const char* last, unsigned threads) {
+    if (format == InputFormat::json && threads > 1 && loadCommoditiesParallel(first, last, threads)) return;
+    loadCommodities(format, first, last);
+}
+
+// Length of the CBOR self-describe tag (55799) at the start of a CBOR file,
+// or 0. The tag only marks the file as CBOR, so it is skipped before parsing.
+static size_t selfDescribeTag(InputFormat format, const unsigned char* head, size_t headSize) {
+    return format == InputFormat::cbor && headSize >= 3 && head[0] == 0xd9 && head[1] == 0xd9 && head[2] == 0xf7 ? 3 : 0;
+}
+
+// Opens a file as a stream positioned at its data and reports its format.
+static bool openInput(const string& path, ifstream& file, CatalogFormat given, InputFormat& format) {
+    file.open(path, ios::binary);
+    if (!file.is_open()) return false;
+    unsigned char head[16];
+    file.read(reinterpret_cast<char*>(head), sizeof(head));
+    size_t headSize = static_cast<size_t>(file.gcount());
+    file.clear();
+    format = detectFormat(path, head, headSize, given);
+    file.seekg(static_cast<streamoff>(selfDescribeTag(format, head, headSize)));
+    return true;
+}
+
+// Reports the format of a mapped file and where its data starts.
+static InputFormat detectFormat(const string& path, const MappedFile& file, CatalogFormat given, const char*& first) {
+    const unsigned char* head = reinterpret_cast<const unsigned char*>(file.begin());
+    size_t headSize = min<size_t>(static_cast<size_t>(file.end() - file.begin()), 16);
+    InputFormat format = detectFormat(path, head, headSize, given);
+    first = file.begin() + selfDescribeTag(format, head, headSize);
+    return format;
+}
+
+void loadData(bool useMmap, const string& materialPath, const string& commodityPath, unsigned threads, bool allowUndefinedMaterials,
+              CatalogFormat format) {
+    CatalogAllocationScope allocation;
+    lastCommodityThreads = 1;
+    string openError = "Error opening files. Please ensure the '" + materialPath + "' and '" + commodityPath + "' files exist in the correct location.";
+
+    if (useMmap) {
+        MappedFile materialFile(materialPath.c_str());
+        MappedFile commodityFile(commodityPath.c_str());
+        if (!materialFile.is_open() || !commodityFile.is_open()) {
+            cerr << openError << endl;
+            exit(EXIT_FAILURE);
+        }
+        const char* materialData;
+        const char* commodityData;
+        InputFormat materialFormat = detectFormat(materialPath, materialFile, format, materialData);
+        InputFormat commodityFormat = detectFormat(commodityPath, commodityFile, format, commodityData);
+        loadMaterials(materialFormat, materialData, materialFile.end());
+        loadCommodityText(commodityFormat, commodityData, commodityFile.end(), threads);
+        buildMaterialInputs();
+        linkCatalog(materialPath, commodityPath, allowUndefinedMaterials);
+        return;
+    }
+
+    ifstream materialFile;
+    ifstream commodityFile;
+    InputFormat materialFormat, commodityFormat;
+
+    // Check if files open successfully
+    if (!openInput(materialPath, materialFile, format, materialFormat) ||
+        !openInput(commodityPath, commodityFile, format, commodityFormat)) {
+        cerr << openError << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    loadMaterials(materialFormat, materialFile);
+    if (commodityFormat == InputFormat::json && threads > 1) {
+        string text((istreambuf_iterator<char>(commodityFile)), istreambuf_iterator<char>());
+        loadCommodityText(commodityFormat, text.data(), text.data() + text.size(), threads);
+    } else {
+        loadCommodities(commodityFormat, commodityFile);
+    }
+    buildMaterialInputs();
+    linkCatalog(materialPath, commodityPath, allowUndefinedMaterials);
+
+    // Close files
+    materialFile.close();
+    commodityFile.close();
+}
+
+void releaseCatalog() {
+    // The records must be gone before the memory behind their names is.
+    vector<Materials>().swap(materialDatabase);
+    vector<Commodity>().swap(commodityDatabase);
+    billOfMaterials = BillOfMaterials();
+    materialInputs = BillOfMaterials();
+    materialIndex.clear();
+    commodityIndex.clear();
+    catalogArena.release();
+}
@@ -0,0 +1,235 @@
+#ifndef CATALOG_H
+#define CATALOG_H
+
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include "arena.h"
+
+#define BASIC_NEEDS 1
+#define ESSENTIAL_UTILITIES 2
+#define EDUCATION_AND_HEALTH 3
+#define CONSUMER_GOODS_AND_SERVICES 4
+#define STRATEGIC_INVESTMENTS_AND_INITIATIVES 5
+#define LUXURY_GOODS_AND_SERVICES 6
+#define INFRASTRUCTURE_AND_DEVELOPMENT 7
+#define RESEARCH_AND_INNOVATION 8
+#define ENVIRONMENTAL_CONSERVATION 9
+#define EMERGENCY_SERVICES_AND_DISASTER_MANAGEMENT 10
+
+// Record names and worker lists are allocated from catalogArena while the
+// catalog loads, so a catalog of millions of records costs a few large blocks
+// instead of millions of heap allocations.
+struct Materials {
+  std::pmr::string name;
+  double inventory;
+  double production_capacity;
+  float cost; // updated to float
+};
+
+struct Worker {
+  std::pmr::string name;
+  int hoursWorked;
+  double wage;
+};
+
+// The materials a commodity uses are its row of billOfMaterials.
+struct Commodity {
+  std::pmr::string name;
+  int laborRequired;
+  int laborAvailable;
+  double demand;
+  int priority;
+  std::pmr::vector<Worker> workers;
+};
+
+// Elements of a catalog matrix. They are either owned, or viewed in place in
+// memory that owner keeps alive, e.g. a mapped snapshot. Reads are the same
+// either way; the first change to a viewed array copies it into owned storage.
+template <typename T>
+class CatalogArray {
+public:
+  CatalogArray() = default;
+  CatalogArray(std::initializer_list<T> init) : elements(init) { point(); }
+  CatalogArray(const CatalogArray& other) { *this = other; }
+  CatalogArray(CatalogArray&& other) noexcept { *this = std::move(other); }
+
+  CatalogArray& operator=(const CatalogArray& other) {
+    if (this == &other) return *this;
+    elements = other.elements;
+    owner = other.owner;
+    if (owner) {
+      first = other.first;
+      count = other.count;
+    } else {
+      point();
+    }
+    return *this;
+  }
+
+  CatalogArray& operator=(CatalogArray&& other) noexcept {
+    if (this == &other) return *this;
+    elements = std::move(other.elements);
+    owner = std::move(other.owner);
+    if (owner) {
+      first = other.first;
+      count = other.count;
+    } else {
+      point();
+    }
+    other.owner.reset();
+    other.elements.clear();
+    other.point();
+    return *this;
+  }
+
+  // Views size elements at data instead of owning any.
+  void view(const T* data, size_t size, std::shared_ptr<const void> keepAlive) {
+    std::vector<T>().swap(elements);
+    owner = std::move(keepAlive);
+    first = data;
+    count = size;
+  }
+  bool viewed() const { return owner != nullptr; }
+
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+  const T* data() const { return first; }
+  const T* begin() const { return first; }
+  const T* end() const { return first + count; }
+  const T& operator[](size_t i) const { return first[i]; }
+
+  void push_back(const T& value) {
+    own();
+    elements.push_back(value);
+    point();
+  }
+  template <typename It>
+  void insert(size_t position, It from, It to) {
+    own();
+    elements.insert(elements.begin() + position, from, to);
+    point();
+  }
+  void erase(size_t from, size_t to) {
+    own();
+    elements.erase(elements.begin() + from, elements.begin() + to);
+    point();
+  }
+  T* mutableData() {
+    own();
+    return elements.data();
+  }
+
+private:
+  void own() {
+    if (!owner) return;
+    elements.assign(first, first + count);
+    owner.reset();
+    point();
+  }
+  void point() {
+    first = elements.data();
+    count = elements.size();
+  }
+
+  std::vector<T> elements;
+  std::shared_ptr<const void> owner;
+  const T* first = nullptr;
+  size_t count = 0;
+};
+
+// Input-output coefficients of the whole catalog as one compressed sparse row
+// matrix: row c holds commodity c's usage rate of each material it uses, in
+// the order commodities.json lists them.
+struct BillOfMaterials {
+  CatalogArray<size_t> rowStart{0};
+  CatalogArray<int> materialIds;
+  CatalogArray<double> usageRates;
+
+  size_t rowBegin(int commodityId) const { return rowStart[commodityId]; }
+  size_t rowEnd(int commodityId) const { return rowStart[commodityId + 1]; }
+  size_t rows() const { return rowStart.size() - 1; }
+
+  void appendRow(const std::vector<int>& ids, const std::vector<double>& rates);
+  void replaceRow(int commodityId, const std::vector<int>& ids, const std::vector<double>& rates);
+
+  // y[m] = sum over all rows of usageRate * x[commodity].
+  void multiplyTransposed(const std::vector<double>& x, std::vector<double>& y) const;
+};
+
+// Records are stored contiguously and addressed by dense IDs assigned at load
+// time. Names are only resolved while loading; planning code indexes by ID.
+extern std::vector<Materials> materialDatabase;
+extern std::vector<Commodity> commodityDatabase;
+extern BillOfMaterials billOfMaterials;
+
+// Technology matrix between materials, in the same CSR layout: row m lists the
+// amount of each input material consumed to produce one unit of material m,
+// from the optional "inputs" object in materials.json.
+extern BillOfMaterials materialInputs;
+
+// Backs the strings and vectors inside the catalog records.
+extern Arena catalogArena;
+
+// Makes catalogArena the default memory resource while in scope, so records
+// built by a loader allocate from it. Building with CATALOG_ARENA=0 leaves the
+// default resource alone.
+class CatalogAllocationScope {
+public:
+  CatalogAllocationScope();
+  ~CatalogAllocationScope();
+
+  CatalogAllocationScope(const CatalogAllocationScope&) = delete;
+  CatalogAllocationScope& operator=(const CatalogAllocationScope&) = delete;
+
+private:
+  std::pmr::memory_resource* previous;
+};
+
+// Returns the ID of the named material, adding an empty record for names that
+// materials.json does not define. While loading, such placeholders are
+// reported by the link step.
+int internMaterial(const std::string& name);
+
+// IDs of existing records by name, or -1.
+int findMaterial(const std::string& name);
+int findCommodity(const std::string& name);
+
+// Formats of the catalog files. Detect takes the format from the file
+// extension (.json, .cbor, .msgpack or .mpk, .bson, .ubj or .ubjson, .bjdata
+// or .bjd); without a known extension only unambiguous openings are
+// recognized: the CBOR self-describe tag, and '{', '[' or whitespace for text
+// JSON. Other files need the format named.
+enum class CatalogFormat { Detect, Json, Cbor, MessagePack, Bson, Ubjson, BJData };
+
+// Reads json, cbor, msgpack, bson, ubjson or bjdata; false for other names.
+bool parseCatalogFormat(const std::string& name, CatalogFormat& format);
+
+// Loads the catalog. Either file may be text JSON, CBOR, MessagePack, BSON,
+// UBJSON or BJData, in the given format or else as detected; loading exits if
+// a file's format cannot be told. A text JSON commodity array is parsed on the
+// given number of threads.
+//
+// Loading ends with a link step: every material a commodity or material input
+// names must be defined by the materials file, every usage rate must belong
+// to one of the commodity's materials, and no commodity name may appear twice
+// in the commodities file. All violations are reported at once, the catalog
+// is released and loading exits. With allowUndefinedMaterials, undefined materials
+// only produce warnings and stay as empty records. After loading, all
+// references are IDs, so planning never looks up or inserts names.
+void loadData(bool useMmap, const std::string& materialPath = "materials.json",
+              const std::string& commodityPath = "commodities.json", unsigned threads = 1,
+              bool allowUndefinedMaterials = false, CatalogFormat format = CatalogFormat::Detect);
+
+// Threads the last loadData parsed commodities on: 1 when it used the serial
+// parser, including when the parallel pre-scan gave up on the text.
+unsigned commodityLoadThreads();
+
+// Empties the catalog and frees the arena behind its records in one step.
+void releaseCatalog();
+
+#endif
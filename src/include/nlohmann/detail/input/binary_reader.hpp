@@ -2715,7 +2715,8 @@ class binary_reader
             case token_type::value_unsigned:
                 return sax->number_unsigned(number_lexer.get_number_unsigned());
             case token_type::value_float:
-                return sax->number_float(number_lexer.get_number_float(), std::move(number_string));
+                // the token string is a std::string, string_t may use another allocator
+                return sax->number_float(number_lexer.get_number_float(), string_t(number_string.begin(), number_string.end()));
             case token_type::uninitialized:
             case token_type::literal_true:
             case token_type::literal_false:
@@ -157,6 +157,23 @@ class iterator_input_adapter
         return std::char_traits<char_type>::eof();
     }
 
+    /// the unread input, for lexers that consume runs of characters at once
+    IteratorType remaining_begin() const
+    {
+        return current;
+    }
+
+    IteratorType remaining_end() const
+    {
+        return end;
+    }
+
+    /// skip n characters of the unread input
+    void advance(std::size_t n)
+    {
+        std::advance(current, n);
+    }
+
   private:
     IteratorType current;
     IteratorType end;
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <algorithm> // remove_if
 #include <cstddef>
 #include <string> // string
 #include <utility> // move
@@ -15,6 +16,7 @@
 
 #include <nlohmann/detail/exceptions.hpp>
 #include <nlohmann/detail/macro_scope.hpp>
+#include <nlohmann/detail/meta/detected.hpp>
 #include <nlohmann/detail/string_concat.hpp>
 
 NLOHMANN_JSON_NAMESPACE_BEGIN
@@ -145,6 +147,60 @@ struct json_sax
 
 namespace detail
 {
+
+template<typename ObjectType>
+using detect_append_unsorted = decltype(std::declval<ObjectType&>().append_unsorted(
+                                            std::declval<const typename ObjectType::key_type&>()));
+
+/*!
+@brief adds the members of an object that is being parsed
+
+Members go in with operator[] as they are read, so a later duplicate key
+replaces an earlier one. Object types that provide append_unsorted and
+sort_appended (sorted_map) instead take every member at the back and are put
+in order once, when the object is complete. Members the callback parser
+discards are then left in place until the object is complete as well, so
+that a discarded last duplicate removes its key as it does with operator[].
+*/
+template<typename ObjectType, bool Deferred = is_detected<detect_append_unsorted, ObjectType>::value>
+struct object_builder
+{
+    static constexpr bool deferred = false;
+
+    static typename ObjectType::mapped_type& add(ObjectType& object, const typename ObjectType::key_type& key)
+    {
+        return object[key];
+    }
+
+    static void finish(ObjectType& /*unused*/) {}
+
+    static void remove_discarded(ObjectType& /*unused*/) {}
+};
+
+template<typename ObjectType>
+struct object_builder<ObjectType, true>
+{
+    static constexpr bool deferred = true;
+
+    static typename ObjectType::mapped_type& add(ObjectType& object, const typename ObjectType::key_type& key)
+    {
+        return object.append_unsorted(key);
+    }
+
+    static void finish(ObjectType& object)
+    {
+        object.sort_appended();
+    }
+
+    static void remove_discarded(ObjectType& object)
+    {
+        object.erase(std::remove_if(object.begin(), object.end(), [](const typename ObjectType::value_type & member)
+        {
+            return member.second.is_discarded();
+        }), object.end());
+    }
+};
+
 /*!
 @brief SAX implementation to create a JSON value from SAX events
 
@@ -244,7 +300,7 @@ class json_sax_dom_parser
         JSON_ASSERT(ref_stack.back()->is_object());
 
         // add null at given key and store the reference for later
-        object_element = &(ref_stack.back()->m_value.object->operator[](val));
+        object_element = &object_builder<typename BasicJsonType::object_t>::add(*ref_stack.back()->m_value.object, val);
         return true;
     }
 
@@ -253,6 +309,7 @@ class json_sax_dom_parser
         JSON_ASSERT(!ref_stack.empty());
         JSON_ASSERT(ref_stack.back()->is_object());
 
+        object_builder<typename BasicJsonType::object_t>::finish(*ref_stack.back()->m_value.object);
         ref_stack.back()->set_parents();
         ref_stack.pop_back();
         return true;
@@ -439,7 +496,7 @@ class json_sax_dom_callback_parser
         // add discarded value at given key and store the reference for later
         if (keep && ref_stack.back())
         {
-            object_element = &(ref_stack.back()->m_value.object->operator[](val) = discarded);
+            object_element = &(object_builder<typename BasicJsonType::object_t>::add(*ref_stack.back()->m_value.object, val) = discarded);
         }
 
         return true;
@@ -449,6 +506,8 @@ class json_sax_dom_callback_parser
     {
         if (ref_stack.back())
         {
+            object_builder<typename BasicJsonType::object_t>::finish(*ref_stack.back()->m_value.object);
+            object_builder<typename BasicJsonType::object_t>::remove_discarded(*ref_stack.back()->m_value.object);
             if (!callback(static_cast<int>(ref_stack.size()) - 1, parse_event_t::object_end, *ref_stack.back()))
             {
                 // discard object
@@ -465,7 +524,8 @@ class json_sax_dom_callback_parser
         ref_stack.pop_back();
         keep_stack.pop_back();
 
-        if (!ref_stack.empty() && ref_stack.back() && ref_stack.back()->is_structured())
+        if (!ref_stack.empty() && ref_stack.back() && ref_stack.back()->is_structured()
+                && !(ref_stack.back()->is_object() && object_builder<typename BasicJsonType::object_t>::deferred))
         {
             // remove discarded value
             for (auto it = ref_stack.back()->begin(); it != ref_stack.back()->end(); ++it)
@@ -15,13 +15,32 @@
 #include <cstdlib> // strtof, strtod, strtold, strtoll, strtoull
 #include <initializer_list> // initializer_list
 #include <string> // char_traits, string
+#include <type_traits> // integral_constant, is_same
 #include <utility> // move
 #include <vector> // vector
 
 #include <nlohmann/detail/input/input_adapters.hpp>
 #include <nlohmann/detail/input/position_t.hpp>
+#include <nlohmann/detail/input/simd_scan.hpp>
 #include <nlohmann/detail/macro_scope.hpp>
 
+// std::from_chars for floating-point types: correctly rounded and independent
+// of the locale
+#ifndef JSON_USE_FROM_CHARS
+    #if defined(JSON_HAS_CPP_17) && defined(__has_include)
+        #if __has_include(<charconv>)
+            #include <charconv>
+        #endif
+    #endif
+    #if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+        #define JSON_USE_FROM_CHARS 1
+    #else
+        #define JSON_USE_FROM_CHARS 0
+    #endif
+#elif JSON_USE_FROM_CHARS
+    #include <charconv>
+#endif
+
 NLOHMANN_JSON_NAMESPACE_BEGIN
 namespace detail
 {
@@ -123,7 +142,11 @@ class lexer : public lexer_base<BasicJsonType>
     explicit lexer(InputAdapterType&& adapter, bool ignore_comments_ = false) noexcept
         : ia(std::move(adapter))
         , ignore_comments(ignore_comments_)
+#if JSON_USE_FROM_CHARS
+        , decimal_point_char('.')
+#else
         , decimal_point_char(static_cast<char_int_type>(get_decimal_point()))
+#endif
     {}
 
     // delete because of pointer members
@@ -261,6 +284,8 @@ class lexer : public lexer_base<BasicJsonType>
 
         while (true)
         {
+            bulk_scan_plain_string(is_contiguous_input{});
+
             // get next character
             switch (get())
             {
@@ -926,6 +951,28 @@ class lexer : public lexer_base<BasicJsonType>
         f = std::strtold(str, endptr);
     }
 
+#if JSON_USE_FROM_CHARS
+    /*!
+    @brief convert token_buffer with std::from_chars
+
+    With from_chars, token_buffer always uses '.' as decimal point.
+
+    @return whether the value is representable; out-of-range values are left
+            to strtoull, strtoll and strtof, which saturate
+    */
+    template<typename NumberType>
+    bool from_chars(NumberType& value) const noexcept
+    {
+        const char* first = token_buffer.data();
+        const char* last = first + token_buffer.size();
+        const auto result = std::from_chars(first, last, value);
+
+        // we checked the number format before
+        JSON_ASSERT(result.ec == std::errc::result_out_of_range || result.ptr == last);
+        return result.ec == std::errc();
+    }
+#endif
+
     /*!
     @brief scan a number literal
 
@@ -1248,6 +1295,49 @@ scan_number_done:
         errno = 0;
 
         // try to parse integers first and fall back to floats
+#if JSON_USE_FROM_CHARS
+        if (number_type == token_type::value_unsigned)
+        {
+            unsigned long long x = 0; // NOLINT(google-runtime-int)
+            if (from_chars(x))
+            {
+                value_unsigned = static_cast<number_unsigned_t>(x);
+                if (value_unsigned == x)
+                {
+                    return token_type::value_unsigned;
+                }
+            }
+        }
+        else if (number_type == token_type::value_integer)
+        {
+            long long x = 0; // NOLINT(google-runtime-int)
+            if (from_chars(x))
+            {
+                value_integer = static_cast<number_integer_t>(x);
+                if (value_integer == x)
+                {
+                    return token_type::value_integer;
+                }
+            }
+        }
+
+        if (from_chars(value_float))
+        {
+            return token_type::value_float;
+        }
+
+        // out of range: let strtof produce infinity or zero in the current
+        // locale, as without from_chars
+        for (auto& ch : token_buffer)
+        {
+            if (ch == '.')
+            {
+                ch = get_decimal_point();
+            }
+        }
+        strtof(value_float, token_buffer.data(), &endptr);
+        return token_type::value_float;
+#else
         if (number_type == token_type::value_unsigned)
         {
             const auto x = std::strtoull(token_buffer.data(), &endptr, 10);
@@ -1289,6 +1379,7 @@ scan_number_done:
         JSON_ASSERT(endptr == token_buffer.data() + token_buffer.size());
 
         return token_type::value_float;
+#endif
     }
 
     /*!
@@ -1403,6 +1494,79 @@ scan_number_done:
         token_buffer.push_back(static_cast<typename string_t::value_type>(c));
     }
 
+    /////////////////////
+    // bulk scanning
+    /////////////////////
+
+    /// whether the input is a plain char range that can be scanned in bulk
+    using is_contiguous_input = std::integral_constant < bool, JSON_SIMD_SCAN &&
+                                std::is_same<InputAdapterType, contiguous_bytes_input_adapter>::value >;
+
+    /*
+    @brief consume the characters get() would read next, as a run
+
+    Updates position and token_string as the equivalent get() calls would.
+    The run must not follow an unget() and may contain line feeds.
+    */
+    void consume_run(const char* first, std::size_t n, std::size_t line_feeds)
+    {
+        ia.advance(n);
+        token_string.insert(token_string.end(), first, first + n);
+        position.chars_read_total += n;
+        if (line_feeds == 0)
+        {
+            position.chars_read_current_line += n;
+            return;
+        }
+        position.lines_read += line_feeds;
+        std::size_t line_start = n;
+        while (first[line_start - 1] != '\n')
+        {
+            --line_start;
+        }
+        position.chars_read_current_line = n - line_start;
+    }
+
+    /// after get() read whitespace, also skip the whitespace following it
+    void bulk_skip_whitespace(std::true_type)
+    {
+        if (next_unget || !(current == ' ' || current == '\t' || current == '\n' || current == '\r'))
+        {
+            return;
+        }
+        const char* first = ia.remaining_begin();
+        const std::size_t n = simd_scan::whitespace(first, ia.remaining_end());
+        if (n != 0)
+        {
+            std::size_t line_feeds = 0;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                line_feeds += first[i] == '\n';
+            }
+            consume_run(first, n, line_feeds);
+        }
+    }
+
+    void bulk_skip_whitespace(std::false_type) {}
+
+    /// copy the printable ASCII characters that follow into token_buffer
+    void bulk_scan_plain_string(std::true_type)
+    {
+        if (next_unget)
+        {
+            return;
+        }
+        const char* first = ia.remaining_begin();
+        const std::size_t n = simd_scan::plain_string(first, ia.remaining_end());
+        if (n != 0)
+        {
+            token_buffer.append(first, n);
+            consume_run(first, n, 0);
+        }
+    }
+
+    void bulk_scan_plain_string(std::false_type) {}
+
   public:
     /////////////////////
     // value getters
@@ -1502,6 +1666,7 @@ scan_number_done:
         do
         {
             get();
+            bulk_skip_whitespace(is_contiguous_input{});
         }
         while (current == ' ' || current == '\t' || current == '\n' || current == '\r');
     }
@@ -0,0 +1,132 @@
+//     __ _____ _____ _____
+//  __|  |   __|     |   | |  JSON for Modern C++
+// |  |  |__   |  |  | | | |  version 3.11.2
+// |_____|_____|_____|_|___|  https://github.com/nlohmann/json
+//
+// SPDX-FileCopyrightText: 2013-2022 Niels Lohmann <https://nlohmann.me>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstddef> // size_t
+
+#include <nlohmann/detail/macro_scope.hpp>
+
+#if JSON_SIMD_SCAN
+    #if defined(__AVX2__)
+        #include <immintrin.h>
+    #elif defined(__SSE2__) || defined(_M_X64)
+        #include <emmintrin.h>
+    #endif
+#endif
+
+NLOHMANN_JSON_NAMESPACE_BEGIN
+namespace detail
+{
+
+/*
+@brief bulk scanning of contiguous input for the lexer
+
+Both functions return the length of the longest prefix of [first, last) made
+of bytes of one class. They process 32 bytes per step with AVX2, 16 with SSE2
+(x86-64 baseline, also used on SSE4.2 hosts) and fall back to a byte loop on
+other targets and for the tail.
+*/
+struct simd_scan
+{
+    /// length of the prefix of JSON whitespace (space, tab, line feed, carriage return)
+    static std::size_t whitespace(const char* first, const char* last) noexcept
+    {
+        const char* p = first;
+#if JSON_SIMD_SCAN && defined(__AVX2__)
+        const __m256i space = _mm256_set1_epi8(' ');
+        const __m256i tab = _mm256_set1_epi8('\t');
+        const __m256i lf = _mm256_set1_epi8('\n');
+        const __m256i cr = _mm256_set1_epi8('\r');
+        while (last - p >= 32)
+        {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            const __m256i ws = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, space), _mm256_cmpeq_epi8(v, tab)),
+                                               _mm256_or_si256(_mm256_cmpeq_epi8(v, lf), _mm256_cmpeq_epi8(v, cr)));
+            const unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(ws));
+            if (mask != 0)
+            {
+                return static_cast<std::size_t>(p - first) + static_cast<std::size_t>(__builtin_ctz(mask));
+            }
+            p += 32;
+        }
+#elif JSON_SIMD_SCAN && (defined(__SSE2__) || defined(_M_X64))
+        const __m128i space = _mm_set1_epi8(' ');
+        const __m128i tab = _mm_set1_epi8('\t');
+        const __m128i lf = _mm_set1_epi8('\n');
+        const __m128i cr = _mm_set1_epi8('\r');
+        while (last - p >= 16)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)),
+                                            _mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr)));
+            const unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(ws)) & 0xFFFFu;
+            if (mask != 0)
+            {
+                return static_cast<std::size_t>(p - first) + static_cast<std::size_t>(__builtin_ctz(mask));
+            }
+            p += 16;
+        }
+#endif
+        while (p != last && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+        {
+            ++p;
+        }
+        return static_cast<std::size_t>(p - first);
+    }
+
+    /// length of the prefix of string bytes that need no escaping or UTF-8
+    /// validation: printable ASCII other than quotation mark and reverse solidus
+    static std::size_t plain_string(const char* first, const char* last) noexcept
+    {
+        const char* p = first;
+#if JSON_SIMD_SCAN && defined(__AVX2__)
+        const __m256i quote = _mm256_set1_epi8('"');
+        const __m256i backslash = _mm256_set1_epi8('\\');
+        const __m256i space = _mm256_set1_epi8(' ');
+        while (last - p >= 32)
+        {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            // signed comparison: bytes >= 0x80 are negative and count as special too
+            const __m256i special = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, backslash)),
+                                                    _mm256_cmpgt_epi8(space, v));
+            const unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(special));
+            if (mask != 0)
+            {
+                return static_cast<std::size_t>(p - first) + static_cast<std::size_t>(__builtin_ctz(mask));
+            }
+            p += 32;
+        }
+#elif JSON_SIMD_SCAN && (defined(__SSE2__) || defined(_M_X64))
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i space = _mm_set1_epi8(' ');
+        while (last - p >= 16)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            // signed comparison: bytes >= 0x80 are negative and count as special too
+            const __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+                                                 _mm_cmplt_epi8(v, space));
+            const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+            if (mask != 0)
+            {
+                return static_cast<std::size_t>(p - first) + static_cast<std::size_t>(__builtin_ctz(mask));
+            }
+            p += 16;
+        }
+#endif
+        while (p != last && *p != '"' && *p != '\\' && static_cast<unsigned char>(*p) >= 0x20 && static_cast<unsigned char>(*p) < 0x80)
+        {
+            ++p;
+        }
+        return static_cast<std::size_t>(p - first);
+    }
+};
+
+}  // namespace detail
+NLOHMANN_JSON_NAMESPACE_END
@@ -453,6 +453,11 @@
     #define JSON_USE_IMPLICIT_CONVERSIONS 1
 #endif
 
+// vectorized whitespace and string scanning for contiguous char input
+#ifndef JSON_SIMD_SCAN
+    #define JSON_SIMD_SCAN 0
+#endif
+
 #if JSON_USE_IMPLICIT_CONVERSIONS
     #define JSON_EXPLICIT
 #else
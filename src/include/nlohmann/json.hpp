@@ -60,6 +60,7 @@
 #include <nlohmann/detail/value_t.hpp>
 #include <nlohmann/json_fwd.hpp>
 #include <nlohmann/ordered_map.hpp>
+#include <nlohmann/sorted_map.hpp>
 
 #if defined(JSON_HAS_CPP_17)
     #include <any>
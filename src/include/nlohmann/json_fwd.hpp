@@ -69,6 +69,13 @@ struct ordered_map;
 /// @sa https://json.nlohmann.me/api/ordered_json/
 using ordered_json = basic_json<nlohmann::ordered_map>;
 
+/// @brief a map-like container that keeps its elements in one sorted vector
+template<class Key, class T, class Compare, class Allocator>
+struct sorted_map;
+
+/// @brief specialization that stores object members in a sorted vector
+using sorted_json = basic_json<nlohmann::sorted_map>;
+
 NLOHMANN_JSON_NAMESPACE_END
 
 #endif  // INCLUDE_NLOHMANN_JSON_FWD_HPP_
@@ -0,0 +1,327 @@
+//     __ _____ _____ _____
+//  __|  |   __|     |   | |  JSON for Modern C++
+// |  |  |__   |  |  | | | |  version 3.11.2
+// |_____|_____|_____|_|___|  https://github.com/nlohmann/json
+//
+// SPDX-FileCopyrightText: 2013-2022 Niels Lohmann <https://nlohmann.me>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <algorithm> // is_sorted, lower_bound, stable_sort, unique
+#include <functional> // less
+#include <initializer_list> // initializer_list
+#include <iterator> // input_iterator_tag, iterator_traits
+#include <memory> // allocator, allocator_traits
+#include <stdexcept> // for out_of_range
+#include <tuple> // forward_as_tuple
+#include <type_traits> // enable_if, is_convertible
+#include <utility> // pair, piecewise_construct
+#include <vector> // vector
+
+#include <nlohmann/detail/macro_scope.hpp>
+#include <nlohmann/detail/meta/type_traits.hpp>
+
+NLOHMANN_JSON_NAMESPACE_BEGIN
+
+/// sorted_map: a map-like container that keeps its elements in one vector
+/// sorted by key, for use within nlohmann::basic_json<sorted_map>
+///
+/// Lookups are binary searches over contiguous elements instead of walks over
+/// tree nodes, and an object costs one allocation instead of one per key.
+/// Iteration order is the key order of std::map. Keys are stored non-const so
+/// that insertion can move elements; they must not be modified in place.
+///
+/// Inserting one key is linear in the size of the object, so the parsers do
+/// not insert: they add members with append_unsorted and put the object in
+/// order with sort_appended once it is complete.
+template <class Key, class T, class Compare = std::less<Key>,
+          class Allocator = std::allocator<std::pair<const Key, T>>>
+                  struct sorted_map : std::vector<std::pair<Key, T>,
+                  typename std::allocator_traits<Allocator>::template rebind_alloc<std::pair<Key, T>>>
+{
+    using key_type = Key;
+    using mapped_type = T;
+    using Container = std::vector<std::pair<Key, T>,
+          typename std::allocator_traits<Allocator>::template rebind_alloc<std::pair<Key, T>>>;
+    using allocator_type = typename Container::allocator_type;
+    using iterator = typename Container::iterator;
+    using const_iterator = typename Container::const_iterator;
+    using size_type = typename Container::size_type;
+    using value_type = typename Container::value_type;
+    using key_compare = Compare;
+
+    sorted_map() noexcept(noexcept(Container())) : Container{} {}
+    explicit sorted_map(const allocator_type& alloc) noexcept(noexcept(Container(alloc))) : Container{alloc} {}
+    template <class It>
+    sorted_map(It first, It last, const allocator_type& alloc = allocator_type())
+        : Container{first, last, alloc}
+    {
+        sort_unique();
+    }
+    sorted_map(std::initializer_list<value_type> init, const allocator_type& alloc = allocator_type())
+        : Container{init, alloc}
+    {
+        sort_unique();
+    }
+
+    template<class KeyType, class... Args>
+    std::pair<iterator, bool> emplace(KeyType && key, Args && ... args)
+    {
+        // keys of documents written in key order always go to the back
+        if (this->empty() || m_compare(this->back().first, key))
+        {
+            Container::emplace_back(std::piecewise_construct, std::forward_as_tuple(std::forward<KeyType>(key)),
+                                    std::forward_as_tuple(std::forward<Args>(args)...));
+            return {std::prev(this->end()), true};
+        }
+        auto it = lower_bound(key);
+        if (it != this->end() && !m_compare(key, it->first))
+        {
+            return {it, false};
+        }
+        it = Container::emplace(it, std::piecewise_construct, std::forward_as_tuple(std::forward<KeyType>(key)),
+                                std::forward_as_tuple(std::forward<Args>(args)...));
+        return {it, true};
+    }
+
+    T& operator[](const key_type& key)
+    {
+        return emplace(key).first->second;
+    }
+
+    template<class KeyType, detail::enable_if_t<
+                 detail::is_usable_as_key_type<key_compare, key_type, KeyType>::value, int> = 0>
+    T & operator[](KeyType && key)
+    {
+        return emplace(std::forward<KeyType>(key)).first->second;
+    }
+
+    const T& operator[](const key_type& key) const
+    {
+        return at(key);
+    }
+
+    template<class KeyType, detail::enable_if_t<
+                 detail::is_usable_as_key_type<key_compare, key_type, KeyType>::value, int> = 0>
+    const T & operator[](KeyType && key) const
+    {
+        return at(std::forward<KeyType>(key));
+    }
+
+    T& at(const key_type& key)
+    {
+        auto it = find(key);
+        if (it == this->end())
+        {
+            JSON_THROW(std::out_of_range("key not found"));
+        }
+        return it->second;
+    }
+
+    template<class KeyType, detail::enable_if_t<
+                 detail::is_usable_as_key_type<key_compare, key_type, KeyType>::value, int> = 0>
+    T & at(KeyType && key)
+    {
+        auto it = find(key);
+        if (it == this->end())
+        {
+            JSON_THROW(std::out_of_range("key not found"));
+        }
+        return it->second;
+    }
+
+    const T& at(const key_type& key) const
+    {
+        auto it = find(key);
+        if (it == this->end())
+        {
+            JSON_THROW(std::out_of_range("key not found"));
+        }
+        return it->second;
+    }
+
+    template<class KeyType, detail::enable_if_t<
+                 detail::is_usable_as_key_type<key_compare, key_type, KeyType>::value, int> = 0>
+    const T & at(KeyType && key) const
+    {
+        auto it = find(key);
+        if (it == this->end())
+        {
+            JSON_THROW(std::out_of_range("key not found"));
+        }
+        return it->second;
+    }
+
+    size_type erase(const key_type& key)
+    {
+        auto it = find(key);
+        if (it == this->end())
+        {
+            return 0;
+        }
+        Container::erase(it);
+        return 1;
+    }
+
+    template<class KeyType, detail::enable_if_t<
+                 detail::is_usable_as_key_type<key_compare, key_type, KeyType>::value, int> = 0>
+    size_type erase(KeyType && key)
+    {
+        auto it = find(key);
+        if (it == this->end())
+        {
+            return 0;
+        }
+        Container::erase(it);
+        return 1;
+    }
+
+    iterator erase(iterator pos)
+    {
+        return Container::erase(pos);
+    }
+
+    iterator erase(iterator first, iterator last)
+    {
+        return Container::erase(first, last);
+    }
+
+    size_type count(const key_type& key) const
+    {
+        return find(key) == this->end() ? 0 : 1;
+    }
+
+    template<class KeyType, detail::enable_if_t<
+                 detail::is_usable_as_key_type<key_compare, key_type, KeyType>::value, int> = 0>
+    size_type count(KeyType && key) const
+    {
+        return find(key) == this->end() ? 0 : 1;
+    }
+
+    iterator find(const key_type& key)
+    {
+        auto it = lower_bound(key);
+        return it != this->end() && !m_compare(key, it->first) ? it : this->end();
+    }
+
+    template<class KeyType, detail::enable_if_t<
+                 detail::is_usable_as_key_type<key_compare, key_type, KeyType>::value, int> = 0>
+    iterator find(KeyType && key)
+    {
+        auto it = lower_bound(key);
+        return it != this->end() && !m_compare(key, it->first) ? it : this->end();
+    }
+
+    const_iterator find(const key_type& key) const
+    {
+        auto it = lower_bound(key);
+        return it != this->end() && !m_compare(key, it->first) ? it : this->end();
+    }
+
+    template<class KeyType, detail::enable_if_t<
+                 detail::is_usable_as_key_type<key_compare, key_type, KeyType>::value, int> = 0>
+    const_iterator find(KeyType && key) const
+    {
+        auto it = lower_bound(key);
+        return it != this->end() && !m_compare(key, it->first) ? it : this->end();
+    }
+
+    /// adds a member at the back without looking for its key; the map is not
+    /// usable until sort_appended is called
+    T& append_unsorted(const key_type& key)
+    {
+        Container::emplace_back(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple());
+        return this->back().second;
+    }
+
+    /// sorts members added with append_unsorted; of equal keys the one added
+    /// last is kept, as assigning to operator[] in turn would
+    void sort_appended()
+    {
+        const auto less = [this](const value_type & a, const value_type & b)
+        {
+            return m_compare(a.first, b.first);
+        };
+        if (!std::is_sorted(this->begin(), this->end(), less))
+        {
+            std::stable_sort(this->begin(), this->end(), less);
+        }
+        auto out = this->begin();
+        for (auto it = this->begin(); it != this->end(); ++it)
+        {
+            auto next = std::next(it);
+            if (next != this->end() && !less(*it, *next))
+            {
+                continue;  // a later member has the same key
+            }
+            if (out != it)
+            {
+                *out = std::move(*it);
+            }
+            ++out;
+        }
+        Container::erase(out, this->end());
+    }
+
+    std::pair<iterator, bool> insert( value_type&& value )
+    {
+        return emplace(std::move(value.first), std::move(value.second));
+    }
+
+    std::pair<iterator, bool> insert( const value_type& value )
+    {
+        return emplace(value.first, value.second);
+    }
+
+    template<typename InputIt>
+    using require_input_iter = typename std::enable_if<std::is_convertible<typename std::iterator_traits<InputIt>::iterator_category,
+            std::input_iterator_tag>::value>::type;
+
+    template<typename InputIt, typename = require_input_iter<InputIt>>
+    void insert(InputIt first, InputIt last)
+    {
+        for (auto it = first; it != last; ++it)
+        {
+            insert(*it);
+        }
+    }
+
+private:
+    template<class KeyType>
+    iterator lower_bound(const KeyType& key)
+    {
+        return std::lower_bound(this->begin(), this->end(), key, [this](const value_type & element, const KeyType & k)
+        {
+            return m_compare(element.first, k);
+        });
+    }
+
+    template<class KeyType>
+    const_iterator lower_bound(const KeyType& key) const
+    {
+        return std::lower_bound(this->begin(), this->end(), key, [this](const value_type & element, const KeyType & k)
+        {
+            return m_compare(element.first, k);
+        });
+    }
+
+    // sorts elements given in any order and keeps the first of equal keys,
+    // as inserting them one by one into a std::map would
+    void sort_unique()
+    {
+        std::stable_sort(this->begin(), this->end(), [this](const value_type & a, const value_type & b)
+        {
+            return m_compare(a.first, b.first);
+        });
+        auto last = std::unique(this->begin(), this->end(), [this](const value_type & a, const value_type & b)
+        {
+            return !m_compare(a.first, b.first) && !m_compare(b.first, a.first);
+        });
+        Container::erase(last, this->end());
+    }
+
+    JSON_NO_UNIQUE_ADDRESS key_compare m_compare = key_compare();
+};
+
+NLOHMANN_JSON_NAMESPACE_END
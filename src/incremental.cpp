@@ -0,0 +1,247 @@
+#include "incremental.h"
+#include "pricing.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std;
+
+IncrementalPlanner::IncrementalPlanner() {
+  size_t commodities = commodityDatabase.size();
+  size_t materials = materialDatabase.size();
+  size_t entries = billOfMaterials.materialIds.size();
+
+  current.order = priorityOrder();
+  current.shortage.assign(entries, 0.0);
+  current.commodityCost.assign(commodities, 0.0);
+  position.resize(commodities);
+  for (size_t p = 0; p < commodities; p++) position[current.order[p]] = p;
+
+  entryCommodity.resize(entries);
+  chainStart.assign(materials + 1, 0);
+  for (size_t c = 0; c < commodities; c++) {
+    for (size_t e = billOfMaterials.rowBegin(c); e < billOfMaterials.rowEnd(c); e++) {
+      entryCommodity[e] = static_cast<int>(c);
+      chainStart[billOfMaterials.materialIds[e] + 1]++;
+    }
+  }
+  for (size_t m = 0; m < materials; m++) chainStart[m + 1] += chainStart[m];
+  chainEntries.resize(entries);
+  chainIndex.resize(entries);
+  vector<size_t> next(chainStart.begin(), chainStart.end() - 1);
+  for (int c : current.order) {
+    for (size_t e = billOfMaterials.rowBegin(c); e < billOfMaterials.rowEnd(c); e++) {
+      size_t k = next[billOfMaterials.materialIds[e]]++;
+      chainEntries[k] = e;
+      chainIndex[e] = k;
+    }
+  }
+
+  inventoryBefore.assign(entries, 0.0);
+  used.assign(entries, 0.0);
+  dirty.assign(commodities, 0);
+  for (size_t m = 0; m < materials; m++) recomputeChain(static_cast<int>(m), chainStart[m], chainStart[m + 1]);
+  for (size_t c = 0; c < commodities; c++) {
+    Commodity& commodity = commodityDatabase[c];
+    calculateWages(commodity.workers, commodity.laborRequired, commodity.demand);
+    markDirty(static_cast<int>(c));
+  }
+  updateCosts();
+  calculatePrices(currentPrices);
+}
+
+double IncrementalPlanner::totalCost() const {
+  double totalCost = 0;
+  for (int commodityId : current.order) totalCost += current.commodityCost[commodityId];
+  return totalCost;
+}
+
+double IncrementalPlanner::remainingInventory(int materialId) const {
+  if (chainStart[materialId] == chainStart[materialId + 1]) return materialDatabase[materialId].inventory;
+  size_t last = chainEntries[chainStart[materialId + 1] - 1];
+  return inventoryBefore[last] - used[last];
+}
+
+// Replays the material's chain from index `from`, with the same arithmetic as
+// planCommodity. Entries up to forcedUntil are always recomputed; past that
+// the walk stops at the first entry that receives unchanged inventory.
+void IncrementalPlanner::recomputeChain(int materialId, size_t from, size_t forcedUntil) {
+  const Materials& material = materialDatabase[materialId];
+  size_t end = chainStart[materialId + 1];
+  double inventory = material.inventory;
+  if (from > chainStart[materialId]) {
+    size_t previous = chainEntries[from - 1];
+    inventory = inventoryBefore[previous] - used[previous];
+  }
+  for (size_t k = from; k < end; k++) {
+    size_t e = chainEntries[k];
+    if (k > forcedUntil && inventory == inventoryBefore[e]) break;
+    int commodityId = entryCommodity[e];
+    const Commodity& commodity = commodityDatabase[commodityId];
+    double usageRate = billOfMaterials.usageRates[e];
+    double shortage = 0.0;
+    double requiredAmount = commodity.demand * usageRate;
+    double availableAmount = inventory + material.production_capacity;
+    if (availableAmount < requiredAmount) {
+      shortage = requiredAmount - availableAmount;
+    }
+    if (shortage != current.shortage[e]) {
+      current.shortage[e] = shortage;
+      markDirty(commodityId);
+    }
+    inventoryBefore[e] = inventory;
+    used[e] = min(inventory, commodity.demand * usageRate);
+    inventory -= used[e];
+    work++;
+  }
+}
+
+void IncrementalPlanner::markDirty(int commodityId) {
+  if (dirty[commodityId]) return;
+  dirty[commodityId] = 1;
+  dirtyCommodities.push_back(commodityId);
+}
+
+void IncrementalPlanner::updateCosts() {
+  for (int commodityId : dirtyCommodities) {
+    const Commodity& commodity = commodityDatabase[commodityId];
+    double commodityCost = 0;
+    for (size_t e = billOfMaterials.rowBegin(commodityId); e < billOfMaterials.rowEnd(commodityId); e++) {
+      double shortage = current.shortage[e];
+      if (shortage > 0) {
+        commodityCost += shortage * materialDatabase[billOfMaterials.materialIds[e]].cost;
+      }
+    }
+    commodityCost += commodity.laborRequired * commodity.demand;
+    current.commodityCost[commodityId] = commodityCost;
+    dirty[commodityId] = 0;
+  }
+  dirtyCommodities.clear();
+}
+
+bool IncrementalPlanner::chainBefore(size_t a, size_t b) const {
+  size_t pa = position[entryCommodity[a]];
+  size_t pb = position[entryCommodity[b]];
+  return pa == pb ? a < b : pa < pb;
+}
+
+// Moves a commodity whose sort key changed to its new place in the plan order
+// and in each of its materials' chains, then replays the chains over the span
+// it moved across. A row may list a material more than once; its entries for
+// that material sit together in the chain and move as one block, so the
+// search for the new place only sees entries that are still in order.
+void IncrementalPlanner::reposition(int commodityId) {
+  vector<int>& order = current.order;
+  size_t oldPosition = position[commodityId];
+  order.erase(order.begin() + oldPosition);
+  auto it = lower_bound(order.begin(), order.end(), commodityId, compareCommodity);
+  size_t newPosition = it - order.begin();
+  order.insert(it, commodityId);
+  for (size_t p = min(oldPosition, newPosition); p <= max(oldPosition, newPosition); p++) position[order[p]] = p;
+
+  size_t rowBegin = billOfMaterials.rowBegin(commodityId), rowEnd = billOfMaterials.rowEnd(commodityId);
+  for (size_t e = rowBegin; e < rowEnd; e++) {
+    int m = billOfMaterials.materialIds[e];
+    bool seen = false;
+    for (size_t f = rowBegin; f < e && !seen; f++) seen = billOfMaterials.materialIds[f] == m;
+    if (seen) continue;
+    size_t count = 0;
+    for (size_t f = e; f < rowEnd; f++) count += billOfMaterials.materialIds[f] == m;
+
+    auto chain = chainEntries.begin();
+    size_t oldIndex = chainIndex[e];
+    size_t end = chainStart[m + 1];
+    rotate(chain + oldIndex, chain + oldIndex + count, chain + end);
+    size_t newIndex = lower_bound(chain + chainStart[m], chain + end - count, e,
+                                  [this](size_t a, size_t b) { return chainBefore(a, b); }) - chain;
+    rotate(chain + newIndex, chain + end - count, chain + end);
+    size_t from = min(oldIndex, newIndex), until = max(oldIndex, newIndex) + count - 1;
+    for (size_t k = from; k <= until; k++) chainIndex[chainEntries[k]] = k;
+    recomputeChain(m, from, until);
+  }
+}
+
+void IncrementalPlanner::setMaterialInventory(int materialId, double inventory) {
+  work = 0;
+  materialDatabase[materialId].inventory = inventory;
+  recomputeChain(materialId, chainStart[materialId], chainStart[materialId]);
+  updateCosts();
+}
+
+void IncrementalPlanner::setMaterialCapacity(int materialId, double capacity) {
+  work = 0;
+  materialDatabase[materialId].production_capacity = capacity;
+  recomputeChain(materialId, chainStart[materialId], chainStart[materialId + 1]);
+  updateCosts();
+}
+
+void IncrementalPlanner::setMaterialCost(int materialId, float cost) {
+  work = 0;
+  materialDatabase[materialId].cost = cost;
+  for (size_t k = chainStart[materialId]; k < chainStart[materialId + 1]; k++) {
+    markDirty(entryCommodity[chainEntries[k]]);
+    work++;
+  }
+  for (int commodityId : dirtyCommodities) currentPrices[commodityId] = calculatePrice(commodityId);
+  updateCosts();
+}
+
+void IncrementalPlanner::setCommodityDemand(int commodityId, double demand) {
+  work = 0;
+  Commodity& commodity = commodityDatabase[commodityId];
+  commodity.demand = demand;
+  reposition(commodityId);
+  calculateWages(commodity.workers, commodity.laborRequired, commodity.demand);
+  markDirty(commodityId);
+  updateCosts();
+}
+
+void IncrementalPlanner::setCommodityPriority(int commodityId, int priority) {
+  work = 0;
+  commodityDatabase[commodityId].priority = priority;
+  reposition(commodityId);
+  updateCosts();
+}
+
+string IncrementalPlanner::applyUpdate(const string& update) {
+  size_t kindEnd = update.find(':');
+  size_t equals = update.rfind('=');
+  size_t fieldStart = equals == string::npos ? string::npos : update.rfind(':', equals);
+  if (kindEnd == string::npos || equals == string::npos || fieldStart == string::npos || fieldStart <= kindEnd) {
+    return "Malformed update '" + update + "', expected KIND:NAME:FIELD=VALUE";
+  }
+  string kind = update.substr(0, kindEnd);
+  string name = update.substr(kindEnd + 1, fieldStart - kindEnd - 1);
+  string field = update.substr(fieldStart + 1, equals - fieldStart - 1);
+  string text = update.substr(equals + 1);
+  char* parsed = nullptr;
+  double value = strtod(text.c_str(), &parsed);
+  if (text.empty() || *parsed != '\0') return "Invalid value '" + text + "' in update '" + update + "'";
+
+  if (kind == "material") {
+    int id = findMaterial(name);
+    if (id < 0) return "Unknown material '" + name + "'";
+    if (field == "inventory") {
+      setMaterialInventory(id, value);
+    } else if (field == "production_capacity") {
+      setMaterialCapacity(id, value);
+    } else if (field == "cost") {
+      setMaterialCost(id, static_cast<float>(value));
+    } else {
+      return "Unknown material field '" + field + "'";
+    }
+  } else if (kind == "commodity") {
+    int id = findCommodity(name);
+    if (id < 0) return "Unknown commodity '" + name + "'";
+    if (field == "demand") {
+      setCommodityDemand(id, value);
+    } else if (field == "priority") {
+      setCommodityPriority(id, static_cast<int>(value));
+    } else {
+      return "Unknown commodity field '" + field + "'";
+    }
+  } else {
+    return "Unknown update kind '" + kind + "'";
+  }
+  return "";
+}
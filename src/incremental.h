@@ -0,0 +1,61 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include "planner.h"
+
+#include <string>
+#include <vector>
+
+// Keeps a plan of the whole catalog up to date under small changes. Each
+// material's users form a chain in priority order, and a commodity's draw on a
+// material depends only on what is left of it after the earlier users in that
+// chain. An update therefore only re-walks the affected chains from the
+// changed entry, and stops as soon as the inventory handed down the chain is
+// the same as before. The resulting plan is identical to planning the changed
+// catalog from scratch.
+//
+// materialDatabase inventories stay at their planning-start values.
+class IncrementalPlanner {
+public:
+  IncrementalPlanner();
+
+  const Plan& plan() const { return current; }
+  const std::vector<double>& prices() const { return currentPrices; }
+  double totalCost() const;
+  // What is left of a material after every commodity in the plan has drawn on it.
+  double remainingInventory(int materialId) const;
+  // Bill of materials entries recomputed by the last update.
+  size_t lastUpdateWork() const { return work; }
+
+  void setMaterialInventory(int materialId, double inventory);
+  void setMaterialCapacity(int materialId, double capacity);
+  void setMaterialCost(int materialId, float cost);
+  void setCommodityDemand(int commodityId, double demand);
+  void setCommodityPriority(int commodityId, int priority);
+
+  // Applies "material:NAME:FIELD=VALUE" or "commodity:NAME:FIELD=VALUE".
+  // Returns an error message, or an empty string on success.
+  std::string applyUpdate(const std::string& update);
+
+private:
+  Plan current;
+  std::vector<double> currentPrices;
+  std::vector<size_t> position;      // of each commodity in current.order
+  std::vector<size_t> chainStart;    // per material, into chainEntries
+  std::vector<size_t> chainEntries;  // bill of materials entries by material, in plan order
+  std::vector<size_t> chainIndex;    // of each entry in chainEntries
+  std::vector<int> entryCommodity;
+  std::vector<double> inventoryBefore;
+  std::vector<double> used;
+  std::vector<char> dirty;
+  std::vector<int> dirtyCommodities;
+  size_t work = 0;
+
+  void recomputeChain(int materialId, size_t from, size_t forcedUntil);
+  void markDirty(int commodityId);
+  void updateCosts();
+  void reposition(int commodityId);
+  bool chainBefore(size_t a, size_t b) const;
+};
+
+#endif
@@ -0,0 +1,133 @@
+#include "leontief.h"
+#include "catalog.h"
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+
+vector<double> directMaterialDemand() {
+  vector<double> demand(commodityDatabase.size());
+  for (size_t c = 0; c < commodityDatabase.size(); c++) demand[c] = commodityDatabase[c].demand;
+  vector<double> materialDemand;
+  billOfMaterials.multiplyTransposed(demand, materialDemand);
+  return materialDemand;
+}
+
+// Holds threads until all of them have arrived; the last to arrive runs
+// complete() before any of them continues.
+class SweepBarrier {
+public:
+  explicit SweepBarrier(unsigned threads) : threads(threads) {}
+
+  template <typename Completion>
+  void arriveAndWait(Completion& complete) {
+    unique_lock<mutex> lock(m);
+    unsigned current = generation;
+    if (++arrived == threads) {
+      complete();
+      arrived = 0;
+      generation++;
+      released.notify_all();
+    } else {
+      released.wait(lock, [&] { return generation != current; });
+    }
+  }
+
+private:
+  mutex m;
+  condition_variable released;
+  unsigned threads;
+  unsigned arrived = 0;
+  unsigned generation = 0;
+};
+
+LeontiefSolution solveGrossOutput(const vector<double>& finalDemand, unsigned threads, double tolerance, int maxIterations) {
+  size_t n = materialDatabase.size();
+
+  // Jacobi needs, for each material, the materials that consume it: the
+  // transpose of materialInputs. Self-use is kept apart as the diagonal.
+  vector<size_t> start(n + 1, 0);
+  vector<double> diagonal(n, 1.0);
+  for (size_t m = 0; m < n; m++) {
+    for (size_t e = materialInputs.rowBegin(m); e < materialInputs.rowEnd(m); e++) {
+      int input = materialInputs.materialIds[e];
+      if (input == static_cast<int>(m)) {
+        diagonal[m] -= materialInputs.usageRates[e];
+      } else {
+        start[input + 1]++;
+      }
+    }
+  }
+  for (size_t i = 0; i < n; i++) start[i + 1] += start[i];
+  vector<int> consumers(start[n]);
+  vector<double> amounts(start[n]);
+  vector<size_t> next(start.begin(), start.end() - 1);
+  for (size_t m = 0; m < n; m++) {
+    for (size_t e = materialInputs.rowBegin(m); e < materialInputs.rowEnd(m); e++) {
+      int input = materialInputs.materialIds[e];
+      if (input == static_cast<int>(m)) continue;
+      consumers[next[input]] = static_cast<int>(m);
+      amounts[next[input]++] = materialInputs.usageRates[e];
+    }
+  }
+
+  LeontiefSolution solution;
+  solution.grossOutput = finalDemand;
+  solution.iterations = 0;
+  solution.residual = 0.0;
+  solution.converged = false;
+  double scale = 1.0;
+  for (double d : finalDemand) scale = max(scale, fabs(d));
+  vector<double> updated(n);
+  threads = max(1u, min<unsigned>(threads, static_cast<unsigned>(max<size_t>(n, 1))));
+  vector<double> rowResidual(threads);
+
+  // One sweep computes the Jacobi update of x and, from the same sums, the
+  // residual (I - A)x - d of x itself.
+  auto sweep = [&](unsigned t) {
+    size_t first = n * t / threads;
+    size_t last = n * (t + 1) / threads;
+    const vector<double>& x = solution.grossOutput;
+    double largest = 0.0;
+    for (size_t i = first; i < last; i++) {
+      double sum = finalDemand[i];
+      for (size_t e = start[i]; e < start[i + 1]; e++) sum += amounts[e] * x[consumers[e]];
+      updated[i] = sum / diagonal[i];
+      largest = max(largest, fabs(diagonal[i] * x[i] - sum));
+    }
+    rowResidual[t] = largest;
+  };
+
+  // Between sweeps, on one thread: stop at a small enough residual, keeping
+  // the x it belongs to, or take the update.
+  bool done = false;
+  auto step = [&]() {
+    solution.residual = *max_element(rowResidual.begin(), rowResidual.end());
+    if (solution.residual <= tolerance * scale || !isfinite(solution.residual) || solution.iterations >= maxIterations) {
+      done = true;
+      return;
+    }
+    solution.grossOutput.swap(updated);
+    solution.iterations++;
+  };
+
+  // The workers live for the whole solve and meet at the barrier once per
+  // sweep.
+  SweepBarrier barrier(threads);
+  auto run = [&](unsigned t) {
+    while (!done) {
+      sweep(t);
+      barrier.arriveAndWait(step);
+    }
+  };
+  vector<thread> workers;
+  for (unsigned t = 1; t < threads; t++) workers.emplace_back(run, t);
+  run(0);
+  for (auto& worker : workers) worker.join();
+  solution.converged = solution.residual <= tolerance * scale;
+  return solution;
+}
@@ -0,0 +1,27 @@
+#ifndef LEONTIEF_H
+#define LEONTIEF_H
+
+#include <vector>
+
+struct LeontiefSolution {
+  std::vector<double> grossOutput;
+  int iterations;
+  // Largest element of (I - A)x - d for the returned x.
+  double residual;
+  bool converged;
+};
+
+// Final demand for every material: what the commodities' demands draw on
+// directly through the bill of materials.
+std::vector<double> directMaterialDemand();
+
+// Solves (I - A)x = d for the gross output x of every material, where A is
+// materialInputs and d the final demand, so x also covers the inputs consumed
+// further down the production chain. Uses Jacobi iteration with the rows split
+// across threads that stay up for the whole solve; converges when A is
+// productive (spectral radius below one). Stops once the residual is at most
+// tolerance times the largest final demand (or 1, if that is smaller).
+LeontiefSolution solveGrossOutput(const std::vector<double>& finalDemand, unsigned threads,
+                                  double tolerance = 1e-12, int maxIterations = 10000);
+
+#endif
@@ -0,0 +1,318 @@
+#include "lp.h"
+#include "catalog.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+static const double EPSILON = 1e-9;
+static const double INF = numeric_limits<double>::infinity();
+
+double priorityWeight(int priority) {
+  return max(1, EMERGENCY_SERVICES_AND_DISASTER_MANAGEMENT + 1 - priority);
+}
+
+// Revised simplex for  max c'x  s.t.  Ax + s = b,  0 <= x <= upper,  s >= 0.
+// Variables are the structural columns, then one slack per row. Column j of A
+// is row j of a BillOfMaterials and is read from it in place; only the basis
+// is factorized, as a product of eta matrices B^-1 = E_k ... E_1 that is
+// rebuilt from the slack identity every REFACTOR_INTERVAL pivots. Nonbasic
+// variables sit at one of their bounds.
+class RevisedSimplex {
+public:
+  RevisedSimplex(const BillOfMaterials& columns, size_t structural, size_t rows)
+      : A(columns), m(rows), k(structural), n(structural + rows), rhs(rows, 0.0), cost(n, 0.0), upper(n, INF),
+        value(n, 0.0), basis(rows), atUpper(n, 0), rowOf(n, -1) {}
+
+  void setObjective(size_t j, double c) { cost[j] = c; }
+  void setUpper(size_t j, double u) { upper[j] = u; }
+  void setRhs(size_t r, double b) { rhs[r] = b; }
+
+  // Slack basis; feasible because every rhs is nonnegative.
+  void coldStart() {
+    fill(atUpper.begin(), atUpper.end(), 0);
+    factorize(vector<int>());
+    computeValues();
+  }
+
+  // Factorizes the given basis against the current columns. Returns false,
+  // leaving the slack basis, if it does not fit, is singular or is not primal
+  // feasible.
+  bool warmStart(const vector<int>& startBasis, const vector<char>& startAtUpper) {
+    if (startBasis.size() != m || startAtUpper.size() != n) {
+      coldStart();
+      return false;
+    }
+    vector<char> seen(n, 0);
+    for (int j : startBasis) {
+      if (j < 0 || static_cast<size_t>(j) >= n || seen[j]) {
+        coldStart();
+        return false;
+      }
+      seen[j] = 1;
+    }
+    if (!factorize(startBasis)) {
+      coldStart();
+      return false;
+    }
+    for (size_t j = 0; j < n; j++) atUpper[j] = rowOf[j] < 0 && startAtUpper[j] && upper[j] < INF;
+    computeValues();
+    for (size_t r = 0; r < m; r++) {
+      double v = value[basis[r]];
+      if (v < -EPSILON || v > upper[basis[r]] + EPSILON) {
+        coldStart();
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Returns whether an optimum was reached within the iteration limit.
+  bool optimize(int& iterations) {
+    vector<double> prices(m), direction(m);
+    int degenerate = 0;
+    for (iterations = 0; iterations < 50 * static_cast<int>(n + m) + 1000; iterations++) {
+      // Dantzig's rule, falling back to Bland's after a run of degenerate
+      // pivots so that cycling cannot occur.
+      bool bland = degenerate > 50;
+      for (size_t r = 0; r < m; r++) prices[r] = cost[basis[r]];
+      btran(prices);
+      size_t entering = n;
+      double best = EPSILON;
+      for (size_t j = 0; j < n; j++) {
+        if (rowOf[j] >= 0) continue;
+        double reduced = cost[j] - dot(prices, j);
+        double gain = atUpper[j] ? -reduced : reduced;
+        if (gain > best) {
+          entering = j;
+          best = gain;
+          if (bland) break;
+        }
+      }
+      if (entering == n) return true;
+
+      column(entering, direction);
+      ftran(direction);
+      double sign = atUpper[entering] ? -1.0 : 1.0;
+      double step = upper[entering];
+      size_t leaving = m;
+      bool leavesAtUpper = false;
+      for (size_t r = 0; r < m; r++) {
+        double alpha = direction[r] * sign;
+        int b = basis[r];
+        double limit = INF;
+        bool hitsUpper = false;
+        if (alpha > EPSILON) {
+          limit = (value[b] - 0.0) / alpha;
+        } else if (alpha < -EPSILON && upper[b] < INF) {
+          limit = (upper[b] - value[b]) / -alpha;
+          hitsUpper = true;
+        }
+        if (limit < step || (bland && limit == step && leaving < m && b < basis[leaving])) {
+          step = max(0.0, limit);
+          leaving = r;
+          leavesAtUpper = hitsUpper;
+        }
+      }
+      if (step == INF) return false;
+      degenerate = step <= EPSILON ? degenerate + 1 : 0;
+
+      for (size_t r = 0; r < m; r++) value[basis[r]] -= sign * step * direction[r];
+      value[entering] += sign * step;
+      if (leaving == m) {
+        atUpper[entering] = !atUpper[entering];
+        continue;
+      }
+
+      int old = basis[leaving];
+      value[old] = leavesAtUpper ? upper[old] : 0.0;
+      atUpper[old] = leavesAtUpper;
+      rowOf[old] = -1;
+      atUpper[entering] = 0;
+      appendEta(leaving, direction);
+      basis[leaving] = static_cast<int>(entering);
+      rowOf[entering] = static_cast<int>(leaving);
+      if (etaRow.size() - factorEtas >= REFACTOR_INTERVAL) {
+        if (!factorize(vector<int>(basis))) return false;
+        computeValues();
+      }
+    }
+    return false;
+  }
+
+  double valueOf(size_t j) const { return value[j]; }
+  const vector<int>& currentBasis() const { return basis; }
+  const vector<char>& currentAtUpper() const { return atUpper; }
+
+private:
+  static const size_t REFACTOR_INTERVAL = 64;
+
+  const BillOfMaterials& A;
+  size_t m, k, n;
+  vector<double> rhs, cost, upper, value;
+  vector<int> basis;
+  vector<char> atUpper;
+  vector<int> rowOf;
+
+  // Eta matrices in the order they apply. Eta e replaces row etaRow[e] of the
+  // identity's column by the transformed entering column: etaPivot[e] on the
+  // diagonal, and etaIndex/etaValue[etaStart[e], etaStart[e + 1]) elsewhere.
+  // The first factorEtas come from the last factorization.
+  vector<int> etaRow;
+  vector<double> etaPivot;
+  vector<size_t> etaStart{0};
+  vector<int> etaIndex;
+  vector<double> etaValue;
+  size_t factorEtas = 0;
+
+  double dot(const vector<double>& y, size_t j) const {
+    if (j >= k) return y[j - k];
+    double sum = 0.0;
+    for (size_t e = A.rowBegin(static_cast<int>(j)); e < A.rowEnd(static_cast<int>(j)); e++) sum += y[A.materialIds[e]] * A.usageRates[e];
+    return sum;
+  }
+
+  void column(size_t j, vector<double>& a) const {
+    fill(a.begin(), a.end(), 0.0);
+    if (j >= k) {
+      a[j - k] = 1.0;
+      return;
+    }
+    for (size_t e = A.rowBegin(static_cast<int>(j)); e < A.rowEnd(static_cast<int>(j)); e++) a[A.materialIds[e]] += A.usageRates[e];
+  }
+
+  // a := B^-1 a
+  void ftran(vector<double>& a) const {
+    for (size_t e = 0; e < etaRow.size(); e++) {
+      int p = etaRow[e];
+      double x = a[p] / etaPivot[e];
+      a[p] = x;
+      if (x == 0.0) continue;
+      for (size_t i = etaStart[e]; i < etaStart[e + 1]; i++) a[etaIndex[i]] -= etaValue[i] * x;
+    }
+  }
+
+  // y := y B^-1
+  void btran(vector<double>& y) const {
+    for (size_t e = etaRow.size(); e-- > 0;) {
+      int p = etaRow[e];
+      double sum = y[p];
+      for (size_t i = etaStart[e]; i < etaStart[e + 1]; i++) sum -= etaValue[i] * y[etaIndex[i]];
+      y[p] = sum / etaPivot[e];
+    }
+  }
+
+  void appendEta(size_t p, const vector<double>& d) {
+    etaRow.push_back(static_cast<int>(p));
+    etaPivot.push_back(d[p]);
+    for (size_t i = 0; i < m; i++) {
+      if (i != p && d[i] != 0.0) {
+        etaIndex.push_back(static_cast<int>(i));
+        etaValue.push_back(d[i]);
+      }
+    }
+    etaStart.push_back(etaIndex.size());
+  }
+
+  // Rebuilds the eta file for the basis made of the given variables: starting
+  // from the slack identity, each structural column replaces, of the slacks
+  // not in the basis and not yet replaced, the one where its transformed entry
+  // is largest. Returns false, leaving the slack basis, if the columns are
+  // (numerically) dependent.
+  bool factorize(const vector<int>& variables) {
+    etaRow.clear();
+    etaPivot.clear();
+    etaStart.assign(1, 0);
+    etaIndex.clear();
+    etaValue.clear();
+    fill(rowOf.begin(), rowOf.end(), -1);
+    for (size_t r = 0; r < m; r++) {
+      basis[r] = static_cast<int>(k + r);
+      rowOf[k + r] = static_cast<int>(r);
+    }
+    vector<char> replaceable(m, 1);
+    for (int j : variables) {
+      if (static_cast<size_t>(j) >= k) replaceable[j - k] = 0;
+    }
+    vector<double> d(m);
+    for (int j : variables) {
+      if (static_cast<size_t>(j) >= k) continue;
+      column(j, d);
+      ftran(d);
+      size_t p = m;
+      double largest = 0.0;
+      for (size_t r = 0; r < m; r++) {
+        if (replaceable[r] && fabs(d[r]) > largest) {
+          p = r;
+          largest = fabs(d[r]);
+        }
+      }
+      if (p == m || largest <= EPSILON) {
+        factorize(vector<int>());
+        return false;
+      }
+      appendEta(p, d);
+      replaceable[p] = 0;
+      rowOf[basis[p]] = -1;
+      basis[p] = j;
+      rowOf[j] = static_cast<int>(p);
+    }
+    factorEtas = etaRow.size();
+    return true;
+  }
+
+  // Basic values from b less the nonbasic variables at their upper bounds.
+  void computeValues() {
+    vector<double> b = rhs;
+    for (size_t j = 0; j < n; j++) {
+      value[j] = rowOf[j] < 0 && atUpper[j] ? upper[j] : 0.0;
+      if (rowOf[j] >= 0 || !atUpper[j]) continue;
+      if (j >= k) {
+        b[j - k] -= upper[j];
+      } else {
+        for (size_t e = A.rowBegin(static_cast<int>(j)); e < A.rowEnd(static_cast<int>(j)); e++) b[A.materialIds[e]] -= A.usageRates[e] * upper[j];
+      }
+    }
+    ftran(b);
+    for (size_t r = 0; r < m; r++) value[basis[r]] = b[r];
+  }
+};
+
+Allocation AllocationLP::solve() {
+  size_t commodities = commodityDatabase.size();
+  size_t materials = materialDatabase.size();
+  RevisedSimplex lp(billOfMaterials, commodities, materials);
+
+  for (size_t m = 0; m < materials; m++) {
+    const Materials& material = materialDatabase[m];
+    lp.setRhs(m, max(0.0, material.inventory + material.production_capacity));
+  }
+  for (size_t c = 0; c < commodities; c++) {
+    const Commodity& commodity = commodityDatabase[c];
+    double bound = max(0.0, commodity.demand);
+    if (commodity.laborRequired > 0) bound = min(bound, max(0.0, static_cast<double>(commodity.laborAvailable) / commodity.laborRequired));
+    lp.setUpper(c, bound);
+    lp.setObjective(c, priorityWeight(commodity.priority));
+  }
+
+  Allocation allocation;
+  allocation.warmStarted = !basis.empty() && lp.warmStart(basis, atUpper);
+  if (!allocation.warmStarted) lp.coldStart();
+  allocation.optimal = lp.optimize(allocation.iterations);
+  basis = lp.currentBasis();
+  atUpper = lp.currentAtUpper();
+
+  allocation.fulfilled.resize(commodities);
+  allocation.materialUsed.assign(materials, 0.0);
+  allocation.objective = 0.0;
+  for (size_t c = 0; c < commodities; c++) {
+    allocation.fulfilled[c] = lp.valueOf(c);
+    allocation.objective += priorityWeight(commodityDatabase[c].priority) * allocation.fulfilled[c];
+    for (size_t e = billOfMaterials.rowBegin(c); e < billOfMaterials.rowEnd(c); e++) {
+      allocation.materialUsed[billOfMaterials.materialIds[e]] += billOfMaterials.usageRates[e] * allocation.fulfilled[c];
+    }
+  }
+  return allocation;
+}
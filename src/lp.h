@@ -0,0 +1,39 @@
+#ifndef LP_H
+#define LP_H
+
+#include <vector>
+
+// Weight of one fulfilled unit of demand at a priority level; BASIC_NEEDS
+// counts the most.
+double priorityWeight(int priority);
+
+struct Allocation {
+  std::vector<double> fulfilled;    // units of each commodity that can be made
+  std::vector<double> materialUsed; // per material
+  double objective;
+  int iterations;
+  bool warmStarted;
+  bool optimal;
+};
+
+// Alternative to the greedy priority rule: allocates materials by solving
+//
+//   maximize    sum priorityWeight(priority_c) * f_c
+//   subject to  sum_c usageRate_cm * f_c <= inventory_m + production_capacity_m
+//               0 <= f_c <= min(demand_c, laborAvailable_c / laborRequired_c)
+//
+// with a bounded-variable revised simplex that reads the constraint columns
+// straight from billOfMaterials and keeps only the basis factorized. The
+// optimal basis is kept, and the next solve() factorizes it against the
+// updated catalog and starts from it when it is still feasible, so
+// replanning after small changes takes few pivots.
+class AllocationLP {
+public:
+  Allocation solve();
+
+private:
+  std::vector<int> basis;
+  std::vector<char> atUpper;
+};
+
+#endif
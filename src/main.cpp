@@ -1,200 +1,244 @@
-#include <fstream>
+#include "catalog.h"
+#include "incremental.h"
+#include "leontief.h"
+#include "lp.h"
+#include "number_format.h"
+#include "plan_output.h"
+#include "planner.h"
+#include "pricing.h"
+#include "report.h"
+#include "report_sink.h"
+#include "server.h"
+#include "snapshot.h"
+
 #include <iostream>
 #include <vector>
 #include <string>
-#include <map>
 #include <algorithm>
-#include <nlohmann/json.hpp>
-
-#define BASIC_NEEDS 1
-#define ESSENTIAL_UTILITIES 2
-#define EDUCATION_AND_HEALTH 3
-#define CONSUMER_GOODS_AND_SERVICES 4
-#define STRATEGIC_INVESTMENTS_AND_INITIATIVES 5
-#define LUXURY_GOODS_AND_SERVICES 6
-#define INFRASTRUCTURE_AND_DEVELOPMENT 7
-#define RESEARCH_AND_INNOVATION 8
-#define ENVIRONMENTAL_CONSERVATION 9
-#define EMERGENCY_SERVICES_AND_DISASTER_MANAGEMENT 10
+#include <cerrno>
+#include <cstdlib>
+#include <memory>
+#include <thread>
 
 using namespace std;
 
-struct Materials {
-  string name;
-  double inventory;
-  double production_capacity;
-  float cost; // updated to float
-};
-
-struct Worker {
-  string name;
-  int hoursWorked;
-  double wage;
-};
-
-struct Commodity {
-  string name;
-  vector<string> materialNames;
-  map<string, double> usageRates;
-  int laborRequired;
-  int laborAvailable;
-  double demand;
-  int priority;
-  vector<Worker> workers;
-};
-
-void calculateWages(vector<Worker>& workers, int laborRequired, double demand) {
-  int totalHoursWorked = 0;
-  for (const auto& worker : workers) {
-    totalHoursWorked += worker.hoursWorked;
-  }
-  double wagePerHour;
-  double totalWageBudget = (double)laborRequired * demand;
-  if (totalHoursWorked == 0) {wagePerHour = 0;} else {wagePerHour = totalWageBudget / totalHoursWorked;}
-
-  for (auto& worker : workers) {
-    worker.wage = wagePerHour * worker.hoursWorked;
-  }
+// More threads than this is a typo, not a machine.
+#define MAX_THREADS 4096
+
+// Parses a whole unsigned decimal number in [min, max]. strtoull alone would
+// take "abc" as 0 and "-1" as its largest value.
+static bool parseCount(const char* text, unsigned long long min, unsigned long long max, unsigned long long& value) {
+  if (*text < '0' || *text > '9') return false;
+  errno = 0;
+  char* end = nullptr;
+  unsigned long long parsed = strtoull(text, &end, 10);
+  if (errno == ERANGE || *end != '\0' || parsed < min || parsed > max) return false;
+  value = parsed;
+  return true;
 }
 
-map<string, Materials> materialDatabase;
-map<string, Commodity> commodityDatabase;
-
-double materialBalancePlanning(const string& materialName, double demand, double usageRate) {
-  Materials& material = materialDatabase[materialName];
-  double shortage = 0.0;
-  double requiredAmount = demand * usageRate;
-  double availableAmount = material.inventory + material.production_capacity;
-  if (availableAmount < requiredAmount) {
-    shortage = requiredAmount - availableAmount;
-  }
-  return shortage;
+void printUsage(const char* program) {
+  cerr << "Usage: " << program << " [--mmap] [--threads N] [--leontief] [--lp] [--scan] [--update KIND:NAME:FIELD=VALUE]... [--serve ADDRESS]\n       [--materials FILE] [--commodities FILE] [--input-format F] [--allow-undefined-materials] [--snapshot FILE] [--write-snapshot FILE]\n       [--report-buffer BYTES] [--format text|jsonl|columnar] [--precision N]" << endl;
+  cerr << "  --mmap       map the input files into memory instead of reading them through streams" << endl;
+  cerr << "  --threads N  parse commodities and plan commodities that share no materials on N threads (0 = all cores," << endl;
+  cerr << "               at most " << MAX_THREADS << ")" << endl;
+  cerr << "  --leontief   also report gross material output through the whole production chain" << endl;
+  cerr << "  --lp         allocate scarce materials by linear programming instead of strict priority order" << endl;
+  cerr << "  --scan       plan material by material on the --threads threads instead of commodity by commodity" << endl;
+  cerr << "  --update U   apply a change on top of the loaded catalog and replan incrementally, e.g." << endl;
+  cerr << "               material:Material A:inventory=20 or commodity:Bread:demand=150" << endl;
+  cerr << "  --serve A    keep the catalog loaded and answer requests on Unix socket path A or localhost:PORT" << endl;
+  cerr << "  --materials F         read materials from F (JSON, CBOR, MessagePack, BSON, UBJSON or BJData)" << endl;
+  cerr << "  --commodities F       read commodities from F, in any of the same formats" << endl;
+  cerr << "  --input-format F      read both files as F: json, cbor, msgpack, bson, ubjson or bjdata. Without it the" << endl;
+  cerr << "                        format comes from the extension (.json, .cbor, .msgpack, .bson, .ubj, .bjdata), or" << endl;
+  cerr << "                        for other names only text JSON and tagged CBOR (d9 d9 f7) are recognized" << endl;
+  cerr << "  --allow-undefined-materials  keep materials that commodities use but the materials file lacks as empty records" << endl;
+  cerr << "  --snapshot F          load the catalog from binary snapshot F instead of the JSON files" << endl;
+  cerr << "  --write-snapshot F    convert the loaded catalog to binary snapshot F and exit" << endl;
+  cerr << "  --format F            write the plan as text (out.txt), JSON Lines (out.jsonl) or columnar binary" << endl;
+  cerr << "                        (out.cols); jsonl and columnar cannot be combined with --lp or --leontief" << endl;
+  cerr << "  --precision N         print report numbers with N (1 to " << MAX_PRECISION << ") significant digits instead of the" << endl;
+  cerr << "                        shortest exact form" << endl;
+  cerr << "  --report-buffer B     write the report in chunks of B bytes, 1 to " << MAX_REPORT_BUFFER << " (default "
+       << DEFAULT_REPORT_BUFFER << ")" << endl;
 }
 
-double calculatePrice(const Commodity& commodity) {
-  double totalCost = 0.0;
-  for (const string& materialName : commodity.materialNames) {
-    Materials& material = materialDatabase[materialName];
-    double usageRate = commodity.usageRates.at(materialName);
-    totalCost += usageRate * material.cost;
-  }
-  return totalCost + commodity.laborRequired;
-}
-
-bool compareCommodity(const pair<string, Commodity>& a, const pair<string, Commodity>& b) {
-  if (a.second.priority == b.second.priority)
-    return a.second.demand > b.second.demand;
-  return a.second.priority < b.second.priority;
-}
-
-void loadData() {
-    ifstream materialFile("materials.json");
-    ifstream commodityFile("commodities.json");
-
-    // Check if files open successfully
-    if (!materialFile.is_open() || !commodityFile.is_open()) {
-        cerr << "Error opening files. Please ensure the 'materials.json' and 'commodities.json' files exist in the correct location." << endl;
-        exit(EXIT_FAILURE);
+int main(int argc, char* argv[]) {
+  bool useMmap = false;
+  unsigned threads = 1;
+  bool leontief = false;
+  bool useLp = false;
+  bool useScan = false;
+  vector<string> updates;
+  string serveAddress;
+  string snapshotPath;
+  string materialPath = "materials.json";
+  string commodityPath = "commodities.json";
+  string writeSnapshotPath;
+  bool allowUndefinedMaterials = false;
+  size_t reportBuffer = DEFAULT_REPORT_BUFFER;
+  OutputFormat format = OutputFormat::Text;
+  CatalogFormat inputFormat = CatalogFormat::Detect;
+  for (int i = 1; i < argc; i++) {
+    string arg = argv[i];
+    if (arg == "--mmap") {
+      useMmap = true;
+    } else if (arg == "--update" && i + 1 < argc) {
+      updates.push_back(argv[++i]);
+    } else if (arg == "--materials" && i + 1 < argc) {
+      materialPath = argv[++i];
+    } else if (arg == "--commodities" && i + 1 < argc) {
+      commodityPath = argv[++i];
+    } else if (arg == "--input-format" && i + 1 < argc) {
+      if (!parseCatalogFormat(argv[++i], inputFormat)) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+      }
+    } else if (arg == "--allow-undefined-materials") {
+      allowUndefinedMaterials = true;
+    } else if (arg == "--snapshot" && i + 1 < argc) {
+      snapshotPath = argv[++i];
+    } else if (arg == "--write-snapshot" && i + 1 < argc) {
+      writeSnapshotPath = argv[++i];
+    } else if (arg == "--report-buffer" && i + 1 < argc) {
+      unsigned long long bytes;
+      if (!parseCount(argv[++i], 1, MAX_REPORT_BUFFER, bytes)) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+      }
+      reportBuffer = static_cast<size_t>(bytes);
+    } else if (arg == "--precision" && i + 1 < argc) {
+      int precision;
+      if (!parsePrecision(argv[++i], precision)) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+      }
+      setReportPrecision(precision);
+    } else if (arg == "--format" && i + 1 < argc) {
+      if (!parseOutputFormat(argv[++i], format)) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+      }
+    } else if (arg == "--serve" && i + 1 < argc) {
+      serveAddress = argv[++i];
+    } else if (arg == "--scan") {
+      useScan = true;
+    } else if (arg == "--lp") {
+      useLp = true;
+    } else if (arg == "--leontief") {
+      leontief = true;
+    } else if (arg == "--threads" && i + 1 < argc) {
+      unsigned long long count;
+      if (!parseCount(argv[++i], 0, MAX_THREADS, count)) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+      }
+      threads = static_cast<unsigned>(count);
+      if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+    } else {
+      printUsage(argv[0]);
+      return EXIT_FAILURE;
     }
+  }
 
-    nlohmann::json materialJson, commodityJson;
+  if (format != OutputFormat::Text && (useLp || leontief)) {
+    printUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
 
-    try {
-        materialFile >> materialJson;
-        commodityFile >> commodityJson;
-    } catch (nlohmann::json::parse_error &e) {
-        cerr << "Parse error: " << e.what() << '\n';
-        exit(EXIT_FAILURE);
+  if (snapshotPath.empty()) {
+    loadData(useMmap, materialPath, commodityPath, threads, allowUndefinedMaterials, inputFormat);
+  } else {
+    string error;
+    if (!loadSnapshot(snapshotPath, error)) {
+      cerr << "Snapshot error: " << error << endl;
+      return EXIT_FAILURE;
     }
-
-    for (const auto &item : materialJson.items()) {
-        Materials m;
-        try {
-            m.name = item.key();
-            m.inventory = item.value().at("inventory");
-            m.production_capacity = item.value().at("production_capacity");
-            m.cost = item.value().at("cost");
-        } catch (nlohmann::json::out_of_range &e) {
-            cerr << "Json key error in materials.json: " << e.what() << '\n';
-            exit(EXIT_FAILURE);
-        }
-        materialDatabase[m.name] = m;
+  }
+  if (!writeSnapshotPath.empty()) {
+    string error;
+    if (!writeSnapshot(writeSnapshotPath, error)) {
+      cerr << "Snapshot error: " << error << endl;
+      return EXIT_FAILURE;
     }
+    return EXIT_SUCCESS;
+  }
+  if (!serveAddress.empty()) {
+    return runServer(serveAddress);
+  }
 
-    for (const auto &item : commodityJson.items()) {
-        Commodity c;
-        try {
-            c.name = item.value().at("name");
-            c.materialNames = item.value().at("materialNames").get<vector<string>>();
-            for (const auto &rate : item.value().at("usageRates").items()) {
-                c.usageRates[rate.key()] = rate.value();
-            }
-            c.laborRequired = item.value().at("laborRequired");
-            c.laborAvailable = item.value().at("laborAvailable");
-            c.demand = item.value().at("demand");
-            c.priority = item.value().at("priority");
-            for (const auto &worker : item.value().at("workers")) {
-                c.workers.push_back(Worker{worker.at("name"), worker.at("hoursWorked"), worker.at("wage")});
-            }
-        } catch (nlohmann::json::out_of_range &e) {
-            cerr << "Json key error in commodities.json: " << e.what() << '\n';
-            exit(EXIT_FAILURE);
-        }
-        commodityDatabase[c.name] = c;
+  unique_ptr<IncrementalPlanner> incremental;
+  if (!updates.empty()) {
+    incremental.reset(new IncrementalPlanner());
+    for (const string& update : updates) {
+      string error = incremental->applyUpdate(update);
+      if (!error.empty()) {
+        cerr << error << endl;
+        return EXIT_FAILURE;
+      }
     }
+  }
 
-    // Close files
-    materialFile.close();
-    commodityFile.close();
-}
-
-int main() {
-
-  loadData();
   streambuf* oldCoutStreamBuf = cout.rdbuf();
-  ofstream fileOut("out.txt");
-  cout.rdbuf(fileOut.rdbuf());
-
-  vector<pair<string, Commodity>> commodityVector(commodityDatabase.begin(), commodityDatabase.end());
-  sort(commodityVector.begin(), commodityVector.end(), compareCommodity);
+  ReportSink fileOut(reportBuffer);
+  const char* outputPath = outputFileName(format);
+  if (!fileOut.open(outputPath)) {
+    cerr << "Error opening " << outputPath << " for writing" << endl;
+    return EXIT_FAILURE;
+  }
+  cout.rdbuf(&fileOut);
+
+  // The chain requirements are compared against inventory before planning
+  // draws it down.
+  LeontiefSolution chain;
+  vector<double> available;
+  if (leontief) {
+    chain = solveGrossOutput(directMaterialDemand(), threads);
+    for (const auto& material : materialDatabase) available.push_back(material.inventory + material.production_capacity);
+  }
 
-  double totalCost = 0;
-  for (const auto& c : commodityVector) {
-    Commodity& commodity = commodityDatabase[c.first];
-    double commodityCost = 0;
-    cout << "Commodity: " << commodity.name << endl;
-    for (const auto& materialName : commodity.materialNames) {
-      double usageRate = commodity.usageRates[materialName];
-      double shortage = materialBalancePlanning(materialName, commodity.demand, usageRate);
-      if (shortage > 0) {
-        cout << " Shortage of " << materialName << ": " << shortage << endl;
-        commodityCost += shortage * materialDatabase[materialName].cost;
-        cout << " Cost to fix shortage: " << shortage * materialDatabase[materialName].cost << endl;
-      }
-      else {
-        cout << " No shortage of " << materialName << endl;
-      }
-      double actualUsage = min(materialDatabase[materialName].inventory, commodity.demand * usageRate);
-      materialDatabase[materialName].inventory -= actualUsage;
+  vector<double> prices;
+  calculatePrices(prices);
+
+  if (useLp) {
+    AllocationLP allocator;
+    printAllocation(cout, allocator.solve(), prices);
+  } else if (incremental) {
+    unique_ptr<PlanRecordWriter> records = makeRecordWriter(format, cout, incremental->prices());
+    if (records) {
+      writePlanRecords(*records, incremental->plan());
+    } else {
+      printPlan(cout, incremental->plan(), incremental->prices());
     }
-
-    double laborRequired = commodity.laborRequired * commodity.demand;
-    if (commodity.laborAvailable < laborRequired) {
-      cout << " Labor shortage for " << commodity.name << ". Required: " << laborRequired << ", Available: " << commodity.laborAvailable << endl;
+  } else {
+    Plan plan;
+    unique_ptr<PlanRecordWriter> records = makeRecordWriter(format, cout, prices);
+    if (useScan) {
+      planScan(plan, threads);
+      if (records) writePlanRecords(*records, plan);
+    } else if (threads > 1) {
+      planParallel(plan, threads);
+      if (records) writePlanRecords(*records, plan);
+    } else if (records) {
+      planSequential(plan, [&](int commodityId) { records->commodity(commodityId, plan); });
+      records->finish();
+    } else {
+      planSequential(plan);
     }
+    if (!records) printPlan(cout, plan, prices);
+  }
 
-    commodityCost += commodity.laborRequired * commodity.demand;
-    totalCost += commodityCost;
-    cout << " Total cost for " << commodity.name << ": " << commodityCost << endl;
-    double price = calculatePrice(commodity);
-    cout << " Price for " << commodity.name << ": " << price << endl;
-
-    calculateWages(commodity.workers, commodity.laborRequired, commodity.demand);
-    for (const auto& worker : commodity.workers) {
-      cout << " Wage for " << worker.name << ": " << worker.wage << endl;
+  if (leontief) {
+    if (!chain.converged) {
+      cerr << "Leontief solver did not converge after " << chain.iterations << " iterations (residual " << chain.residual << ")" << endl;
     }
+    printChain(cout, chain, available);
   }
-  cout << "Total cost for all commodities: " << totalCost << endl;
   cout.rdbuf(oldCoutStreamBuf);
+  if (!fileOut.close()) {
+    cerr << "Error writing " << outputPath << endl;
+    return EXIT_FAILURE;
+  }
   return 0;
 }
@@ -0,0 +1,50 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Read-only memory mapping of a whole file. Readers work on the mapped bytes
+// directly, e.g. the parser takes them as a pointer range, so input is read
+// straight from the page cache shared by every process mapping the file.
+class MappedFile {
+public:
+  explicit MappedFile(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return;
+    struct stat st;
+    if (fstat(fd, &st) == 0) {
+      size = static_cast<size_t>(st.st_size);
+      if (size == 0) {
+        ok = true;
+      } else {
+        void* addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (addr != MAP_FAILED) {
+          madvise(addr, size, MADV_SEQUENTIAL);
+          data = static_cast<const char*>(addr);
+          ok = true;
+        }
+      }
+    }
+    close(fd);
+  }
+  ~MappedFile() {
+    if (data) munmap(const_cast<char*>(data), size);
+  }
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  bool is_open() const { return ok; }
+  const char* begin() const { return data; }
+  const char* end() const { return data + size; }
+
+private:
+  const char* data = nullptr;
+  size_t size = 0;
+  bool ok = false;
+};
+
+#endif
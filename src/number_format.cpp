@@ -0,0 +1,35 @@
+#include "number_format.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <nlohmann/json.hpp>
+
+using namespace std;
+
+size_t formatNumber(char* buffer, double value, int precision) {
+  if (precision > 0 || !isfinite(value)) {
+    // snprintf returns the length the whole text would have had.
+    int length = snprintf(buffer, NUMBER_BUFFER, "%.*g", precision > 0 ? precision : 6, value);
+    if (length < 0) return 0;
+    return min(static_cast<size_t>(length), static_cast<size_t>(NUMBER_BUFFER - 1));
+  }
+  char* end = nlohmann::detail::to_chars(buffer, buffer + NUMBER_BUFFER, value);
+  if (end - buffer >= 2 && end[-2] == '.' && end[-1] == '0') end -= 2;
+  return static_cast<size_t>(end - buffer);
+}
+
+bool parsePrecision(const char* text, int& precision) {
+  char* end = nullptr;
+  long digits = strtol(text, &end, 10);
+  if (end == text || *end != '\0' || digits < 1 || digits > MAX_PRECISION) return false;
+  precision = static_cast<int>(digits);
+  return true;
+}
+
+ostream& operator<<(ostream& out, FormattedNumber number) {
+  char buffer[NUMBER_BUFFER];
+  out.write(buffer, static_cast<streamsize>(formatNumber(buffer, number.value, number.precision)));
+  return out;
+}
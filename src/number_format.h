@@ -0,0 +1,32 @@
+#ifndef NUMBER_FORMAT_H
+#define NUMBER_FORMAT_H
+
+#include <cstddef>
+#include <ostream>
+
+// Large enough for any double in either mode.
+#define NUMBER_BUFFER 32
+
+// Significant digits that are worth printing: 17 always round-trip a double.
+#define MAX_PRECISION 17
+
+// Writes value to buffer without a terminating NUL and returns its length.
+// With precision 0 this is the shortest text that reads back as the same
+// double (Grisu2 via the vendored detail::to_chars), without the ".0" JSON
+// appends to integers. Otherwise it is printf("%.*g", precision), which is
+// what ostream << double prints at that precision.
+// Output that would not fit NUMBER_BUFFER is cut short.
+size_t formatNumber(char* buffer, double value, int precision = 0);
+
+// Parses a --precision argument, a whole number from 1 to MAX_PRECISION.
+bool parsePrecision(const char* text, int& precision);
+
+// Streams a double through formatNumber, e.g. out << FormattedNumber{x, 0}.
+struct FormattedNumber {
+  double value;
+  int precision;
+};
+
+std::ostream& operator<<(std::ostream& out, FormattedNumber number);
+
+#endif
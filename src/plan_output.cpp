@@ -0,0 +1,206 @@
+#include "plan_output.h"
+
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+using namespace std;
+
+static const char COLUMNAR_MAGIC[8] = {'P', 'L', 'A', 'N', 'C', 'O', 'L', 'S'};
+static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+bool parseOutputFormat(const string& name, OutputFormat& format) {
+  if (name == "text") {
+    format = OutputFormat::Text;
+  } else if (name == "jsonl") {
+    format = OutputFormat::JsonLines;
+  } else if (name == "columnar") {
+    format = OutputFormat::Columnar;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+const char* outputFileName(OutputFormat format) {
+  switch (format) {
+    case OutputFormat::JsonLines: return "out.jsonl";
+    case OutputFormat::Columnar: return "out.cols";
+    default: return "out.txt";
+  }
+}
+
+static double laborShortage(const Commodity& commodity) {
+  double laborRequired = commodity.laborRequired * commodity.demand;
+  return commodity.laborAvailable < laborRequired ? laborRequired - commodity.laborAvailable : 0.0;
+}
+
+// Serializes each record straight into the stream; ordered_json keeps the
+// keys in the order they are set. Names from binary inputs and snapshots are
+// not checked for UTF-8, so invalid sequences are written as U+FFFD rather
+// than ending the report with an exception.
+class JsonLinesWriter : public PlanRecordWriter {
+public:
+  JsonLinesWriter(ostream& out, const vector<double>& prices)
+    : out(out), prices(prices),
+      serializer(nlohmann::detail::output_adapter<char>(out), ' ', nlohmann::detail::error_handler_t::replace) {}
+
+  void commodity(int commodityId, const Plan& plan) override {
+    const Commodity& commodity = commodityDatabase[commodityId];
+    nlohmann::ordered_json materials = nlohmann::ordered_json::array();
+    for (size_t e = billOfMaterials.rowBegin(commodityId); e < billOfMaterials.rowEnd(commodityId); e++) {
+      const Materials& material = materialDatabase[billOfMaterials.materialIds[e]];
+      double shortage = plan.shortage[e];
+      materials.push_back({{"material", material.name}, {"shortage", shortage},
+                           {"shortageCost", shortage > 0 ? shortage * material.cost : 0.0}});
+    }
+    nlohmann::ordered_json wages = nlohmann::ordered_json::array();
+    for (const auto& worker : commodity.workers) {
+      wages.push_back({{"worker", worker.name}, {"wage", worker.wage}});
+    }
+
+    double cost = plan.commodityCost[commodityId];
+    totalCost += cost;
+    nlohmann::ordered_json record = {
+      {"commodity", commodity.name},
+      {"id", commodityId},
+      {"priority", commodity.priority},
+      {"demand", commodity.demand},
+      {"materials", std::move(materials)},
+      {"laborShortage", laborShortage(commodity)},
+      {"cost", cost},
+      {"price", prices[commodityId]},
+      {"wages", std::move(wages)},
+    };
+    serializer.dump(record, false, false, 0);
+    out << '\n';
+  }
+
+  void finish() override {
+    serializer.dump(nlohmann::ordered_json{{"totalCost", totalCost}}, false, false, 0);
+    out << '\n';
+  }
+
+private:
+  ostream& out;
+  const vector<double>& prices;
+  nlohmann::detail::serializer<nlohmann::ordered_json> serializer;
+  double totalCost = 0;
+};
+
+// Collects up to COLUMNAR_BLOCK_ROWS records column by column and writes
+// them as one block.
+class ColumnarWriter : public PlanRecordWriter {
+public:
+  ColumnarWriter(ostream& out, const vector<double>& prices) : out(out), prices(prices) {
+    uint32_t version = COLUMNAR_VERSION;
+    uint64_t materials = materialDatabase.size();
+    vector<uint64_t> nameOffsets{0};
+    string names;
+    for (const Materials& material : materialDatabase) {
+      names += material.name;
+      nameOffsets.push_back(names.size());
+    }
+    out.write(COLUMNAR_MAGIC, sizeof(COLUMNAR_MAGIC));
+    put(&version, 1);
+    put(&BYTE_ORDER_MARK, 1);
+    put(&materials, 1);
+    put(nameOffsets.data(), nameOffsets.size());
+    out.write(names.data(), static_cast<streamsize>(names.size()));
+  }
+
+  void commodity(int commodityId, const Plan& plan) override {
+    const Commodity& commodity = commodityDatabase[commodityId];
+    size_t begin = billOfMaterials.rowBegin(commodityId);
+    size_t end = billOfMaterials.rowEnd(commodityId);
+    for (size_t e = begin; e < end; e++) {
+      double shortage = plan.shortage[e];
+      materialIds.push_back(billOfMaterials.materialIds[e]);
+      shortages.push_back(shortage);
+      shortageCosts.push_back(shortage > 0 ? shortage * materialDatabase[billOfMaterials.materialIds[e]].cost : 0.0);
+    }
+    for (const auto& worker : commodity.workers) {
+      wages.push_back(worker.wage);
+      workerNameLengths.push_back(static_cast<uint32_t>(worker.name.size()));
+      workerNames += worker.name;
+    }
+
+    double cost = plan.commodityCost[commodityId];
+    totalCost += cost;
+    commodityIds.push_back(commodityId);
+    costs.push_back(cost);
+    commodityPrices.push_back(prices[commodityId]);
+    laborShortages.push_back(laborShortage(commodity));
+    entryCounts.push_back(static_cast<uint32_t>(end - begin));
+    workerCounts.push_back(static_cast<uint32_t>(commodity.workers.size()));
+    nameLengths.push_back(static_cast<uint32_t>(commodity.name.size()));
+    commodityNames += commodity.name;
+    if (commodityIds.size() == COLUMNAR_BLOCK_ROWS) writeBlock();
+  }
+
+  void finish() override {
+    if (!commodityIds.empty()) writeBlock();
+    uint32_t end[4] = {0, 0, 0, 0};
+    put(end, 4);
+    put(&totalCost, 1);
+  }
+
+private:
+  template <typename T>
+  void put(const T* data, size_t count) {
+    out.write(reinterpret_cast<const char*>(data), static_cast<streamsize>(count * sizeof(T)));
+  }
+
+  template <typename T>
+  void column(vector<T>& data) {
+    put(data.data(), data.size());
+    data.clear();
+  }
+
+  void writeBlock() {
+    uint32_t counts[4] = {static_cast<uint32_t>(commodityIds.size()), static_cast<uint32_t>(materialIds.size()),
+                          static_cast<uint32_t>(wages.size()), static_cast<uint32_t>(commodityNames.size() + workerNames.size())};
+    put(counts, 4);
+    column(commodityIds);
+    column(costs);
+    column(commodityPrices);
+    column(laborShortages);
+    column(entryCounts);
+    column(workerCounts);
+    column(nameLengths);
+    column(materialIds);
+    column(shortages);
+    column(shortageCosts);
+    column(wages);
+    column(workerNameLengths);
+    out.write(commodityNames.data(), static_cast<streamsize>(commodityNames.size()));
+    out.write(workerNames.data(), static_cast<streamsize>(workerNames.size()));
+    commodityNames.clear();
+    workerNames.clear();
+  }
+
+  ostream& out;
+  const vector<double>& prices;
+  double totalCost = 0;
+
+  vector<int32_t> commodityIds;
+  vector<double> costs, commodityPrices, laborShortages;
+  vector<uint32_t> entryCounts, workerCounts, nameLengths;
+  vector<int32_t> materialIds;
+  vector<double> shortages, shortageCosts;
+  vector<double> wages;
+  vector<uint32_t> workerNameLengths;
+  string commodityNames, workerNames;
+};
+
+unique_ptr<PlanRecordWriter> makeRecordWriter(OutputFormat format, ostream& out, const vector<double>& prices) {
+  switch (format) {
+    case OutputFormat::JsonLines: return unique_ptr<PlanRecordWriter>(new JsonLinesWriter(out, prices));
+    case OutputFormat::Columnar: return unique_ptr<PlanRecordWriter>(new ColumnarWriter(out, prices));
+    default: return nullptr;
+  }
+}
+
+void writePlanRecords(PlanRecordWriter& writer, const Plan& plan) {
+  for (int commodityId : plan.order) writer.commodity(commodityId, plan);
+  writer.finish();
+}
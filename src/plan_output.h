@@ -0,0 +1,57 @@
+#ifndef PLAN_OUTPUT_H
+#define PLAN_OUTPUT_H
+
+#include "planner.h"
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Formats of the plan report. Text is the human-readable out.txt; the others
+// are for programs and carry one record per commodity with its material
+// shortages, cost, price and wages.
+//
+// JsonLines: one JSON object per line in plan order, then {"totalCost": x}.
+// Names that are not valid UTF-8 have each invalid byte sequence replaced by
+// U+FFFD.
+//
+// Columnar: a header (magic "PLANCOLS", uint32 version, uint32 byte-order
+// mark, uint64 material count, uint64 name offsets[materials + 1], name bytes)
+// followed by blocks of up to COLUMNAR_BLOCK_ROWS commodities. A block starts
+// with uint32 rows, entries, workers and string bytes, then holds the columns
+// one after another:
+//   int32 commodityId, double cost, price, laborShortage, uint32 entryCount,
+//   workerCount, nameLength                                 [rows]
+//   int32 materialId, double shortage, shortageCost          [entries]
+//   double wage, uint32 workerNameLength                     [workers]
+//   char strings (commodity names, then worker names)        [string bytes]
+// A block of zero rows followed by a double total cost ends the file. Values
+// are in host byte order.
+enum class OutputFormat { Text, JsonLines, Columnar };
+
+#define COLUMNAR_VERSION 1
+#define COLUMNAR_BLOCK_ROWS 4096
+
+// Parses "text", "jsonl" or "columnar".
+bool parseOutputFormat(const std::string& name, OutputFormat& format);
+const char* outputFileName(OutputFormat format);
+
+// Writes records as commodities are planned, so output streams out while the
+// plan loop runs instead of after it.
+class PlanRecordWriter {
+public:
+  virtual ~PlanRecordWriter() = default;
+  // Called once per commodity in plan order, after it has been planned.
+  virtual void commodity(int commodityId, const Plan& plan) = 0;
+  // Ends the output after the last commodity.
+  virtual void finish() = 0;
+};
+
+// Null for OutputFormat::Text. prices must outlive the writer.
+std::unique_ptr<PlanRecordWriter> makeRecordWriter(OutputFormat format, std::ostream& out, const std::vector<double>& prices);
+
+// Writes the records of an already complete plan.
+void writePlanRecords(PlanRecordWriter& writer, const Plan& plan);
+
+#endif
@@ -0,0 +1,291 @@
+#include "planner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+
+void calculateWages(pmr::vector<Worker>& workers, int laborRequired, double demand) {
+  int totalHoursWorked = 0;
+  for (const auto& worker : workers) {
+    totalHoursWorked += worker.hoursWorked;
+  }
+  double wagePerHour;
+  double totalWageBudget = (double)laborRequired * demand;
+  if (totalHoursWorked == 0) {wagePerHour = 0;} else {wagePerHour = totalWageBudget / totalHoursWorked;}
+
+  for (auto& worker : workers) {
+    worker.wage = wagePerHour * worker.hoursWorked;
+  }
+}
+
+double materialBalancePlanning(int materialId, double demand, double usageRate) {
+  const Materials& material = materialDatabase[materialId];
+  double shortage = 0.0;
+  double requiredAmount = demand * usageRate;
+  double availableAmount = material.inventory + material.production_capacity;
+  if (availableAmount < requiredAmount) {
+    shortage = requiredAmount - availableAmount;
+  }
+  return shortage;
+}
+
+bool compareCommodity(int a, int b) {
+  const Commodity& ca = commodityDatabase[a];
+  const Commodity& cb = commodityDatabase[b];
+  if (ca.priority == cb.priority) {
+    if (ca.demand == cb.demand)
+      return a < b;
+    return ca.demand > cb.demand;
+  }
+  return ca.priority < cb.priority;
+}
+
+// Commodities are bucketed by priority in one counting pass, so only the
+// commodities within a bucket are compared, by demand. Priorities outside
+// BASIC_NEEDS..EMERGENCY_SERVICES_AND_DISASTER_MANAGEMENT go to a bucket
+// before or after the others and are sorted in full.
+vector<int> priorityOrder() {
+  const int FIRST = BASIC_NEEDS;
+  const int LAST = EMERGENCY_SERVICES_AND_DISASTER_MANAGEMENT;
+  const int BUCKETS = LAST - FIRST + 3;
+  auto bucketOf = [&](int priority) {
+    if (priority < FIRST) return 0;
+    if (priority > LAST) return BUCKETS - 1;
+    return priority - FIRST + 1;
+  };
+
+  vector<size_t> bucketStart(BUCKETS + 1, 0);
+  for (const Commodity& commodity : commodityDatabase) bucketStart[bucketOf(commodity.priority) + 1]++;
+  for (int b = 0; b < BUCKETS; b++) bucketStart[b + 1] += bucketStart[b];
+
+  vector<int> order(commodityDatabase.size());
+  vector<size_t> next(bucketStart.begin(), bucketStart.end() - 1);
+  for (size_t i = 0; i < commodityDatabase.size(); i++) {
+    order[next[bucketOf(commodityDatabase[i].priority)]++] = static_cast<int>(i);
+  }
+  for (int b = 0; b < BUCKETS; b++) {
+    sort(order.begin() + bucketStart[b], order.begin() + bucketStart[b + 1], compareCommodity);
+  }
+  return order;
+}
+
+static void startPlan(Plan& plan) {
+  plan.order = priorityOrder();
+  plan.shortage.assign(billOfMaterials.materialIds.size(), 0.0);
+  plan.commodityCost.assign(commodityDatabase.size(), 0.0);
+}
+
+// Prices a commodity whose shortages are known and computes its wages.
+static void costCommodity(int commodityId, Plan& plan) {
+  Commodity& commodity = commodityDatabase[commodityId];
+  double commodityCost = 0;
+  for (size_t e = billOfMaterials.rowBegin(commodityId); e < billOfMaterials.rowEnd(commodityId); e++) {
+    double shortage = plan.shortage[e];
+    if (shortage > 0) {
+      commodityCost += shortage * materialDatabase[billOfMaterials.materialIds[e]].cost;
+    }
+  }
+  commodityCost += commodity.laborRequired * commodity.demand;
+  plan.commodityCost[commodityId] = commodityCost;
+
+  calculateWages(commodity.workers, commodity.laborRequired, commodity.demand);
+}
+
+void planCommodity(int commodityId, Plan& plan) {
+  Commodity& commodity = commodityDatabase[commodityId];
+  for (size_t e = billOfMaterials.rowBegin(commodityId); e < billOfMaterials.rowEnd(commodityId); e++) {
+    Materials& material = materialDatabase[billOfMaterials.materialIds[e]];
+    double usageRate = billOfMaterials.usageRates[e];
+    plan.shortage[e] = materialBalancePlanning(billOfMaterials.materialIds[e], commodity.demand, usageRate);
+    double actualUsage = min(material.inventory, commodity.demand * usageRate);
+    material.inventory -= actualUsage;
+  }
+  costCommodity(commodityId, plan);
+}
+
+void planSequential(Plan& plan, const function<void(int)>& onPlanned) {
+  startPlan(plan);
+  for (int commodityId : plan.order) {
+    planCommodity(commodityId, plan);
+    if (onPlanned) onPlanned(commodityId);
+  }
+}
+
+// Edges of the material-conflict graph over positions in the plan order: each
+// commodity waits for the previous user of each of its materials.
+struct ConflictGraph {
+  vector<size_t> successorStart;
+  vector<int> successors;
+  vector<atomic<int>> pending;
+
+  explicit ConflictGraph(const vector<int>& order) : successorStart(order.size() + 1, 0), pending(order.size()) {
+    vector<int> lastUser(materialDatabase.size(), -1);
+    vector<pair<int, int>> edges;
+    vector<int> predecessors;
+    for (size_t p = 0; p < order.size(); p++) {
+      predecessors.clear();
+      int c = order[p];
+      for (size_t e = billOfMaterials.rowBegin(c); e < billOfMaterials.rowEnd(c); e++) {
+        int m = billOfMaterials.materialIds[e];
+        int previous = lastUser[m];
+        if (previous >= 0 && previous != static_cast<int>(p) &&
+            find(predecessors.begin(), predecessors.end(), previous) == predecessors.end()) {
+          predecessors.push_back(previous);
+          edges.emplace_back(previous, static_cast<int>(p));
+        }
+        lastUser[m] = static_cast<int>(p);
+      }
+      pending[p].store(static_cast<int>(predecessors.size()), memory_order_relaxed);
+    }
+
+    for (const auto& edge : edges) successorStart[edge.first + 1]++;
+    for (size_t p = 0; p < order.size(); p++) successorStart[p + 1] += successorStart[p];
+    successors.resize(edges.size());
+    vector<size_t> next(successorStart.begin(), successorStart.end() - 1);
+    for (const auto& edge : edges) successors[next[edge.first]++] = edge.second;
+  }
+};
+
+// Each worker pops ready tasks from the back of its own deque and steals from
+// the front of the others' when it runs dry.
+class WorkStealingPool {
+public:
+  explicit WorkStealingPool(unsigned threads) : queues(threads) {}
+
+  void push(unsigned worker, int task) {
+    lock_guard<mutex> lock(queues[worker].lock);
+    queues[worker].tasks.push_back(task);
+  }
+
+  bool next(unsigned worker, int& task) {
+    {
+      Queue& own = queues[worker];
+      lock_guard<mutex> lock(own.lock);
+      if (!own.tasks.empty()) {
+        task = own.tasks.back();
+        own.tasks.pop_back();
+        return true;
+      }
+    }
+    for (size_t i = 1; i < queues.size(); i++) {
+      Queue& victim = queues[(worker + i) % queues.size()];
+      lock_guard<mutex> lock(victim.lock);
+      if (!victim.tasks.empty()) {
+        task = victim.tasks.front();
+        victim.tasks.pop_front();
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  struct Queue {
+    mutex lock;
+    deque<int> tasks;
+  };
+  vector<Queue> queues;
+};
+
+void planParallel(Plan& plan, unsigned threads) {
+  if (threads <= 1) {
+    planSequential(plan);
+    return;
+  }
+  startPlan(plan);
+  const vector<int>& order = plan.order;
+  ConflictGraph graph(order);
+  WorkStealingPool pool(threads);
+  for (size_t p = 0, worker = 0; p < order.size(); p++) {
+    if (graph.pending[p].load(memory_order_relaxed) == 0) {
+      pool.push(worker, static_cast<int>(p));
+      worker = (worker + 1) % threads;
+    }
+  }
+
+  atomic<size_t> remaining(order.size());
+  auto run = [&](unsigned worker) {
+    int task;
+    while (remaining.load(memory_order_acquire) > 0) {
+      if (!pool.next(worker, task)) {
+        this_thread::yield();
+        continue;
+      }
+      planCommodity(order[task], plan);
+      for (size_t s = graph.successorStart[task]; s < graph.successorStart[task + 1]; s++) {
+        int successor = graph.successors[s];
+        if (graph.pending[successor].fetch_sub(1, memory_order_acq_rel) == 1) {
+          pool.push(worker, successor);
+        }
+      }
+      remaining.fetch_sub(1, memory_order_release);
+    }
+  };
+
+  vector<thread> workers;
+  for (unsigned t = 1; t < threads; t++) workers.emplace_back(run, t);
+  run(0);
+  for (auto& worker : workers) worker.join();
+}
+
+// Runs body(i) for i in [0, n) on up to threads threads, handing out grain
+// indices at a time.
+template <typename Body>
+static void parallelFor(size_t n, unsigned threads, size_t grain, Body body) {
+  atomic<size_t> next(0);
+  auto run = [&]() {
+    for (;;) {
+      size_t begin = next.fetch_add(grain, memory_order_relaxed);
+      if (begin >= n) return;
+      size_t end = min(n, begin + grain);
+      for (size_t i = begin; i < end; i++) body(i);
+    }
+  };
+  vector<thread> workers;
+  for (unsigned t = 1; t < threads && t * grain < n; t++) workers.emplace_back(run);
+  run();
+  for (auto& worker : workers) worker.join();
+}
+
+void planScan(Plan& plan, unsigned threads) {
+  startPlan(plan);
+  const vector<int>& order = plan.order;
+  size_t materials = materialDatabase.size();
+
+  // The bill of materials transposed into one column per material, holding
+  // its entries and the amounts they request in plan order.
+  vector<size_t> columnStart(materials + 1, 0);
+  for (size_t e = 0; e < billOfMaterials.materialIds.size(); e++) columnStart[billOfMaterials.materialIds[e] + 1]++;
+  for (size_t m = 0; m < materials; m++) columnStart[m + 1] += columnStart[m];
+  vector<size_t> columnEntries(billOfMaterials.materialIds.size());
+  vector<double> requested(billOfMaterials.materialIds.size());
+  vector<size_t> next(columnStart.begin(), columnStart.end() - 1);
+  for (int commodityId : order) {
+    double demand = commodityDatabase[commodityId].demand;
+    for (size_t e = billOfMaterials.rowBegin(commodityId); e < billOfMaterials.rowEnd(commodityId); e++) {
+      size_t position = next[billOfMaterials.materialIds[e]]++;
+      columnEntries[position] = e;
+      requested[position] = demand * billOfMaterials.usageRates[e];
+    }
+  }
+
+  // Each column runs the same recurrence as planCommodity, so shortages and
+  // remaining inventory are bit-identical to planning in sequence.
+  parallelFor(materials, threads, 16, [&](size_t m) {
+    Materials& material = materialDatabase[m];
+    double inventory = material.inventory;
+    for (size_t p = columnStart[m]; p < columnStart[m + 1]; p++) {
+      double requiredAmount = requested[p];
+      double availableAmount = inventory + material.production_capacity;
+      plan.shortage[columnEntries[p]] = availableAmount < requiredAmount ? requiredAmount - availableAmount : 0.0;
+      inventory -= min(inventory, requiredAmount);
+    }
+    material.inventory = inventory;
+  });
+
+  parallelFor(order.size(), threads, 256, [&](size_t p) { costCommodity(order[p], plan); });
+}
@@ -0,0 +1,46 @@
+#ifndef PLANNER_H
+#define PLANNER_H
+
+#include "catalog.h"
+
+#include <functional>
+#include <vector>
+
+// Result of planning the catalog in priority order. shortage is indexed like
+// the entries of billOfMaterials, commodityCost by commodity ID.
+struct Plan {
+  std::vector<int> order;
+  std::vector<double> shortage;
+  std::vector<double> commodityCost;
+};
+
+void calculateWages(std::pmr::vector<Worker>& workers, int laborRequired, double demand);
+double materialBalancePlanning(int materialId, double demand, double usageRate);
+// Priority first, then larger demand; ties fall back to load order so the
+// plan order is the same on every run.
+bool compareCommodity(int a, int b);
+
+// Commodity IDs sorted by compareCommodity.
+std::vector<int> priorityOrder();
+
+// Checks one commodity's materials against the current inventory, draws down
+// what it uses and computes its wages.
+void planCommodity(int commodityId, Plan& plan);
+
+// Plans every commodity in priority order, one at a time, calling onPlanned
+// with each commodity ID as soon as it is done.
+void planSequential(Plan& plan, const std::function<void(int)>& onPlanned = nullptr);
+
+// Plans commodities that share no materials concurrently. A commodity only
+// starts once every earlier commodity using one of its materials is done, so
+// each material is drawn down in exactly the sequential priority order.
+void planParallel(Plan& plan, unsigned threads);
+
+// Plans material by material instead of commodity by commodity. Each
+// material's inventory only depends on the requests for that material, so
+// every material's column of the bill of materials is run down in priority
+// order on its own, on up to threads threads, and commodities are priced
+// once all shortages are known. Results match planSequential exactly.
+void planScan(Plan& plan, unsigned threads);
+
+#endif
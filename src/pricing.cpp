@@ -0,0 +1,135 @@
+#include "pricing.h"
+#include "catalog.h"
+
+#include <algorithm>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define PRICING_X86 1
+#endif
+
+using namespace std;
+
+SimdLevel detectSimdLevel() {
+#ifdef PRICING_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) return SimdLevel::AVX512;
+  if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+#endif
+  return SimdLevel::Scalar;
+}
+
+double calculatePrice(int commodityId) {
+  double totalCost = 0.0;
+  for (size_t e = billOfMaterials.rowBegin(commodityId); e < billOfMaterials.rowEnd(commodityId); e++) {
+    const Materials& material = materialDatabase[billOfMaterials.materialIds[e]];
+    totalCost += billOfMaterials.usageRates[e] * material.cost;
+  }
+  return totalCost + commodityDatabase[commodityId].laborRequired;
+}
+
+// Material costs of commodities [first, last) into prices, one row at a time.
+static void priceRowsScalar(const vector<double>& materialCost, size_t first, size_t last, vector<double>& prices) {
+  const BillOfMaterials& bom = billOfMaterials;
+  for (size_t c = first; c < last; c++) {
+    double totalCost = 0.0;
+    for (size_t e = bom.rowStart[c]; e < bom.rowStart[c + 1]; e++) {
+      totalCost += bom.usageRates[e] * materialCost[bom.materialIds[e]];
+    }
+    prices[c] = totalCost;
+  }
+}
+
+#ifdef PRICING_X86
+// Four commodities per iteration, one per lane. Lanes whose row is exhausted
+// gather zeros, and adding +0.0 leaves their sums unchanged.
+__attribute__((target("avx2"), optimize("fp-contract=off")))
+static size_t priceRowsAVX2(const vector<double>& materialCost, vector<double>& prices) {
+  const BillOfMaterials& bom = billOfMaterials;
+  const long long* rowStart = reinterpret_cast<const long long*>(bom.rowStart.data());
+  const int* ids = bom.materialIds.data();
+  const double* rates = bom.usageRates.data();
+  const double* cost = materialCost.data();
+  size_t rows = bom.rows();
+  size_t c = 0;
+  for (; c + 4 <= rows; c += 4) {
+    __m256i begin = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rowStart + c));
+    __m256i end = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rowStart + c + 1));
+    __m256i length = _mm256_sub_epi64(end, begin);
+    long long lengths[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lengths), length);
+    long long longest = max(max(lengths[0], lengths[1]), max(lengths[2], lengths[3]));
+
+    __m256d sum = _mm256_setzero_pd();
+    for (long long k = 0; k < longest; k++) {
+      __m256i step = _mm256_set1_epi64x(k);
+      __m256i active = _mm256_cmpgt_epi64(length, step);
+      __m256i entry = _mm256_add_epi64(begin, step);
+      __m128i activeIds = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(active, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6)));
+      __m128i material = _mm256_mask_i64gather_epi32(_mm_setzero_si128(), ids, entry, activeIds, 4);
+      __m256d rate = _mm256_mask_i64gather_pd(_mm256_setzero_pd(), rates, entry, _mm256_castsi256_pd(active), 8);
+      __m256d unitCost = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), cost, material, _mm256_castsi256_pd(active), 8);
+      sum = _mm256_add_pd(sum, _mm256_mul_pd(rate, unitCost));
+    }
+    _mm256_storeu_pd(prices.data() + c, sum);
+  }
+  return c;
+}
+
+// Same as priceRowsAVX2 with eight lanes and mask registers.
+__attribute__((target("avx512f"), optimize("fp-contract=off")))
+static size_t priceRowsAVX512(const vector<double>& materialCost, vector<double>& prices) {
+  const BillOfMaterials& bom = billOfMaterials;
+  const long long* rowStart = reinterpret_cast<const long long*>(bom.rowStart.data());
+  const int* ids = bom.materialIds.data();
+  const double* rates = bom.usageRates.data();
+  const double* cost = materialCost.data();
+  size_t rows = bom.rows();
+  size_t c = 0;
+  for (; c + 8 <= rows; c += 8) {
+    __m512i begin = _mm512_loadu_si512(rowStart + c);
+    __m512i end = _mm512_loadu_si512(rowStart + c + 1);
+    __m512i length = _mm512_sub_epi64(end, begin);
+    long long lengths[8];
+    _mm512_storeu_si512(lengths, length);
+    long long longest = *max_element(lengths, lengths + 8);
+
+    __m512d sum = _mm512_setzero_pd();
+    for (long long k = 0; k < longest; k++) {
+      __m512i step = _mm512_set1_epi64(k);
+      __mmask8 active = _mm512_cmpgt_epi64_mask(length, step);
+      __m512i entry = _mm512_add_epi64(begin, step);
+      __m256i material = _mm512_mask_i64gather_epi32(_mm256_setzero_si256(), active, entry, ids, 4);
+      __m512d rate = _mm512_mask_i64gather_pd(_mm512_setzero_pd(), active, entry, rates, 8);
+      __m512d unitCost = _mm512_mask_i32gather_pd(_mm512_setzero_pd(), active, material, cost, 8);
+      sum = _mm512_add_pd(sum, _mm512_mul_pd(rate, unitCost));
+    }
+    _mm512_storeu_pd(prices.data() + c, sum);
+  }
+  return c;
+}
+#endif
+
+void calculatePrices(vector<double>& prices, SimdLevel level) {
+  vector<double> materialCost(materialDatabase.size());
+  for (size_t m = 0; m < materialDatabase.size(); m++) materialCost[m] = materialDatabase[m].cost;
+
+  size_t rows = billOfMaterials.rows();
+  prices.assign(rows, 0.0);
+  size_t done = 0;
+#ifdef PRICING_X86
+  if (level == SimdLevel::AVX512) {
+    done = priceRowsAVX512(materialCost, prices);
+  } else if (level == SimdLevel::AVX2) {
+    done = priceRowsAVX2(materialCost, prices);
+  }
+#endif
+  priceRowsScalar(materialCost, done, rows, prices);
+
+  for (size_t c = 0; c < rows; c++) prices[c] += commodityDatabase[c].laborRequired;
+}
+
+void calculatePrices(vector<double>& prices) {
+  static const SimdLevel level = detectSimdLevel();
+  calculatePrices(prices, level);
+}
@@ -0,0 +1,22 @@
+#ifndef PRICING_H
+#define PRICING_H
+
+#include <vector>
+
+enum class SimdLevel { Scalar, AVX2, AVX512 };
+
+// Widest instruction set the batch pricing kernels can use on this CPU.
+SimdLevel detectSimdLevel();
+
+// Price of one commodity: its material costs at the catalog's usage rates plus
+// the labor it requires.
+double calculatePrice(int commodityId);
+
+// Prices the whole catalog at once from the dense material cost vector and the
+// bill of materials. Each lane of the vector kernels accumulates one commodity
+// in row order with separate multiplies and adds, so the results are
+// bit-identical to calculatePrice.
+void calculatePrices(std::vector<double>& prices, SimdLevel level);
+void calculatePrices(std::vector<double>& prices);
+
+#endif
@@ -0,0 +1,77 @@
+#include "report.h"
+#include "number_format.h"
+
+#include <iostream>
+
+using namespace std;
+
+static int reportPrecision = 0;
+
+void setReportPrecision(int digits) {
+  reportPrecision = digits;
+}
+
+static FormattedNumber num(double value) {
+  return FormattedNumber{value, reportPrecision};
+}
+
+void printPlan(ostream& out, const Plan& plan, const vector<double>& prices) {
+  double totalCost = 0;
+  for (int commodityId : plan.order) {
+    const Commodity& commodity = commodityDatabase[commodityId];
+    out << "Commodity: " << commodity.name << '\n';
+    for (size_t e = billOfMaterials.rowBegin(commodityId); e < billOfMaterials.rowEnd(commodityId); e++) {
+      const Materials& material = materialDatabase[billOfMaterials.materialIds[e]];
+      double shortage = plan.shortage[e];
+      if (shortage > 0) {
+        out << " Shortage of " << material.name << ": " << num(shortage) << '\n';
+        out << " Cost to fix shortage: " << num(shortage * material.cost) << '\n';
+      }
+      else {
+        out << " No shortage of " << material.name << '\n';
+      }
+    }
+
+    double laborRequired = commodity.laborRequired * commodity.demand;
+    if (commodity.laborAvailable < laborRequired) {
+      out << " Labor shortage for " << commodity.name << ". Required: " << num(laborRequired) << ", Available: " << commodity.laborAvailable << '\n';
+    }
+
+    double commodityCost = plan.commodityCost[commodityId];
+    totalCost += commodityCost;
+    out << " Total cost for " << commodity.name << ": " << num(commodityCost) << '\n';
+    out << " Price for " << commodity.name << ": " << num(prices[commodityId]) << '\n';
+
+    for (const auto& worker : commodity.workers) {
+      out << " Wage for " << worker.name << ": " << num(worker.wage) << '\n';
+    }
+  }
+  out << "Total cost for all commodities: " << num(totalCost) << '\n';
+}
+
+void printAllocation(ostream& out, const Allocation& allocation, const vector<double>& prices) {
+  if (!allocation.optimal) {
+    cerr << "Allocation LP stopped after " << allocation.iterations << " iterations without reaching an optimum" << endl;
+  }
+  for (int commodityId : priorityOrder()) {
+    const Commodity& commodity = commodityDatabase[commodityId];
+    out << "Commodity: " << commodity.name << '\n';
+    out << " Fulfilled demand for " << commodity.name << ": " << num(allocation.fulfilled[commodityId]) << " of " << num(commodity.demand) << '\n';
+    out << " Price for " << commodity.name << ": " << num(prices[commodityId]) << '\n';
+  }
+  for (size_t m = 0; m < materialDatabase.size(); m++) {
+    const Materials& material = materialDatabase[m];
+    out << "Usage of " << material.name << ": " << num(allocation.materialUsed[m]) << " of " << num(material.inventory + material.production_capacity) << " available" << '\n';
+  }
+  out << "Weighted fulfilled demand: " << num(allocation.objective) << '\n';
+}
+
+void printChain(ostream& out, const LeontiefSolution& chain, const vector<double>& available) {
+  out << "Production chain requirements:" << '\n';
+  for (size_t m = 0; m < materialDatabase.size(); m++) {
+    out << " Gross output of " << materialDatabase[m].name << ": " << num(chain.grossOutput[m]) << '\n';
+    if (chain.grossOutput[m] > available[m]) {
+      out << " Chain shortage of " << materialDatabase[m].name << ": " << num(chain.grossOutput[m] - available[m]) << '\n';
+    }
+  }
+}
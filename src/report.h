@@ -0,0 +1,23 @@
+#ifndef REPORT_H
+#define REPORT_H
+
+#include "leontief.h"
+#include "lp.h"
+#include "planner.h"
+
+#include <ostream>
+#include <vector>
+
+// Significant digits of numbers in the reports below. 0, the default, prints
+// each number in the shortest form that reads back as the same double.
+void setReportPrecision(int digits);
+
+// Human-readable report of a plan in priority order, as written to out.txt.
+void printPlan(std::ostream& out, const Plan& plan, const std::vector<double>& prices);
+
+void printAllocation(std::ostream& out, const Allocation& allocation, const std::vector<double>& prices);
+
+// Gross output of every material, and where it exceeds what is available.
+void printChain(std::ostream& out, const LeontiefSolution& chain, const std::vector<double>& available);
+
+#endif
@@ -0,0 +1,82 @@
+#include "report_sink.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+ReportSink::ReportSink(size_t bufferSize) : buffer(max<size_t>(bufferSize, 1)) {
+  setp(buffer.data(), buffer.data() + buffer.size());
+}
+
+ReportSink::~ReportSink() {
+  close();
+}
+
+bool ReportSink::open(const string& path) {
+  close();
+  fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  failed = false;
+  return fd >= 0;
+}
+
+bool ReportSink::close() {
+  if (fd < 0) return !failed;
+  flushBuffer();
+  if (::close(fd) != 0) failed = true;
+  fd = -1;
+  return !failed;
+}
+
+bool ReportSink::writeAll(const char* data, size_t size) {
+  while (size > 0) {
+    ssize_t written = ::write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      failed = true;
+      return false;
+    }
+    data += written;
+    size -= static_cast<size_t>(written);
+  }
+  return true;
+}
+
+bool ReportSink::flushBuffer() {
+  size_t pending = static_cast<size_t>(pptr() - pbase());
+  setp(buffer.data(), buffer.data() + buffer.size());
+  if (fd < 0) return pending == 0;
+  return writeAll(buffer.data(), pending);
+}
+
+ReportSink::int_type ReportSink::overflow(int_type ch) {
+  if (!flushBuffer()) return traits_type::eof();
+  if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+    *pptr() = traits_type::to_char_type(ch);
+    pbump(1);
+  }
+  return traits_type::not_eof(ch);
+}
+
+streamsize ReportSink::xsputn(const char* s, streamsize n) {
+  size_t size = static_cast<size_t>(n);
+  size_t room = static_cast<size_t>(epptr() - pptr());
+  if (size <= room) {
+    memcpy(pptr(), s, size);
+    pbump(static_cast<int>(size));
+    return n;
+  }
+  if (!flushBuffer()) return 0;
+  // Text at least as large as the buffer goes straight to the file.
+  if (size >= buffer.size()) return writeAll(s, size) ? n : 0;
+  memcpy(pptr(), s, size);
+  pbump(static_cast<int>(size));
+  return n;
+}
+
+int ReportSink::sync() {
+  return flushBuffer() ? 0 : -1;
+}
@@ -0,0 +1,41 @@
+#ifndef REPORT_SINK_H
+#define REPORT_SINK_H
+
+#include <cstddef>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#define DEFAULT_REPORT_BUFFER (1 << 20)
+#define MAX_REPORT_BUFFER (1 << 30)
+
+// Output file for reports. Text collects in a user-space buffer and reaches
+// the file in one write() per bufferSize bytes, when the stream is flushed
+// and on close(). Report code writes '\n' rather than endl so that lines do
+// not flush individually.
+class ReportSink : public std::streambuf {
+public:
+  explicit ReportSink(size_t bufferSize = DEFAULT_REPORT_BUFFER);
+  ~ReportSink() override;
+
+  bool open(const std::string& path);
+  // Writes out the buffer and closes the file. Returns false if any write
+  // failed since open().
+  bool close();
+  bool is_open() const { return fd >= 0; }
+
+protected:
+  int_type overflow(int_type ch) override;
+  std::streamsize xsputn(const char* s, std::streamsize n) override;
+  int sync() override;
+
+private:
+  bool writeAll(const char* data, size_t size);
+  bool flushBuffer();
+
+  int fd = -1;
+  bool failed = false;
+  std::vector<char> buffer;
+};
+
+#endif
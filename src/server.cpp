@@ -0,0 +1,294 @@
+#include "server.h"
+#include "catalog.h"
+#include "incremental.h"
+#include "lp.h"
+#include "number_format.h"
+#include "report.h"
+#include "report_sink.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+// Replies carry numbers in their shortest exact form, so clients read back
+// the planner's values bit for bit.
+static FormattedNumber exact(double value) { return FormattedNumber{value, 0}; }
+
+class PlannerService {
+public:
+  string handle(const string& line, bool& stop) {
+    size_t space = line.find(' ');
+    string command = line.substr(0, space);
+    string argument = space == string::npos ? "" : line.substr(space + 1);
+    ostringstream out;
+
+    if (command == "commodity") {
+      int id = findCommodity(argument);
+      if (id < 0) return "ERR unknown commodity '" + argument + "'";
+      const Commodity& commodity = commodityDatabase[id];
+      const Plan& plan = planner.plan();
+      int shortages = 0;
+      for (size_t e = billOfMaterials.rowBegin(id); e < billOfMaterials.rowEnd(id); e++) {
+        if (plan.shortage[e] > 0) shortages++;
+      }
+      out << "OK demand=" << exact(commodity.demand) << " priority=" << commodity.priority << " cost=" << exact(plan.commodityCost[id])
+          << " price=" << exact(planner.prices()[id]) << " shortages=" << shortages;
+    } else if (command == "material") {
+      int id = findMaterial(argument);
+      if (id < 0) return "ERR unknown material '" + argument + "'";
+      const Materials& material = materialDatabase[id];
+      out << "OK inventory=" << exact(material.inventory) << " remaining=" << exact(planner.remainingInventory(id))
+          << " capacity=" << exact(material.production_capacity) << " cost=" << exact(material.cost);
+    } else if (command == "update") {
+      string error = planner.applyUpdate(argument);
+      if (!error.empty()) return "ERR " + error;
+      out << "OK work=" << planner.lastUpdateWork();
+    } else if (command == "total") {
+      out << "OK total=" << exact(planner.totalCost());
+    } else if (command == "replan") {
+      planner = IncrementalPlanner();
+      out << "OK";
+    } else if (command == "allocate") {
+      Allocation allocation = allocator.solve();
+      if (!allocation.optimal) return "ERR allocation did not reach an optimum";
+      out << "OK objective=" << exact(allocation.objective) << " iterations=" << allocation.iterations << " warm=" << allocation.warmStarted;
+    } else if (command == "report") {
+      // Clients may be other local users, so they cannot choose the file.
+      if (!argument.empty()) return "ERR report takes no argument";
+      const string path = "out.txt";
+      ReportSink sink;
+      if (!sink.open(path)) return "ERR cannot write '" + path + "'";
+      ostream file(&sink);
+      printPlan(file, planner.plan(), planner.prices());
+      if (!sink.close()) return "ERR cannot write '" + path + "'";
+      out << "OK";
+    } else if (command == "shutdown") {
+      stop = true;
+      out << "OK";
+    } else {
+      return "ERR unknown command '" + command + "'";
+    }
+    return out.str();
+  }
+
+private:
+  IncrementalPlanner planner;
+  AllocationLP allocator;
+};
+
+// Longest request line accepted; a client that sends more without a newline
+// gets an error and is disconnected.
+static const size_t MAX_LINE = 64 * 1024;
+// A client with this many reply bytes unsent is not read from until it
+// catches up.
+static const size_t MAX_PENDING_OUTPUT = 1024 * 1024;
+
+static bool isSocket(const string& path) {
+  struct stat st;
+  return lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode);
+}
+
+static bool setNonBlocking(int fd) {
+  int flags = fcntl(fd, F_GETFL, 0);
+  return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+static int listenOn(const string& address) {
+  const string localhost = "localhost:";
+  int fd;
+  if (address.compare(0, localhost.size(), localhost) == 0) {
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    int yes = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(static_cast<uint16_t>(atoi(address.c_str() + localhost.size())));
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+      close(fd);
+      return -1;
+    }
+  } else {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    if (address.size() >= sizeof(addr.sun_path)) {
+      errno = ENAMETOOLONG;
+      return -1;
+    }
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, address.c_str());
+    // Only a socket nobody answers on is replaced: a running server's socket
+    // and any other kind of file at the path are left alone.
+    struct stat st;
+    if (lstat(address.c_str(), &st) == 0) {
+      bool stale = false;
+      if (S_ISSOCK(st.st_mode)) {
+        int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+        stale = probe >= 0 && connect(probe, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 && errno == ECONNREFUSED;
+        if (probe >= 0) close(probe);
+      }
+      if (!stale) {
+        errno = EADDRINUSE;
+        return -1;
+      }
+      unlink(address.c_str());
+    }
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+      close(fd);
+      return -1;
+    }
+  }
+  if (listen(fd, 64) < 0 || !setNonBlocking(fd)) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// A connection and its unparsed input and unsent replies. Sockets are
+// non-blocking: replies are queued and written as the client takes them.
+struct Client {
+  explicit Client(int fd) : fd(fd) {}
+
+  int fd;
+  string input;
+  string output;
+  size_t sent = 0;
+  bool closing = false; // close once the queued replies are sent
+
+  size_t pending() const { return output.size() - sent; }
+};
+
+// Reads what has arrived. Returns false when the connection failed; at end
+// of input the client is closed once its replies are sent.
+static bool readInput(Client& client) {
+  char chunk[4096];
+  ssize_t n;
+  do {
+    n = read(client.fd, chunk, sizeof(chunk));
+  } while (n < 0 && errno == EINTR);
+  if (n > 0) {
+    client.input.append(chunk, static_cast<size_t>(n));
+  } else if (n == 0) {
+    client.closing = true;
+  } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+    return false;
+  }
+  return true;
+}
+
+// Writes queued replies until the socket is full. Returns false when the
+// connection failed.
+static bool writeOutput(Client& client) {
+  while (client.pending() > 0) {
+    ssize_t n = write(client.fd, client.output.data() + client.sent, client.pending());
+    if (n < 0 && errno == EINTR) continue;
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+    if (n <= 0) return false;
+    client.sent += static_cast<size_t>(n);
+  }
+  client.output.clear();
+  client.sent = 0;
+  return true;
+}
+
+int runServer(const string& address) {
+  signal(SIGPIPE, SIG_IGN);
+  int listener = listenOn(address);
+  if (listener < 0) {
+    cerr << "Cannot listen on " << address << ": " << strerror(errno) << endl;
+    return EXIT_FAILURE;
+  }
+
+  PlannerService service;
+  vector<Client> clients;
+  vector<pollfd> fds;
+  bool stop = false;
+  for (;;) {
+    // After shutdown only the queued replies are still sent, for at most a
+    // second without progress.
+    fds.assign(1, pollfd{listener, static_cast<short>(stop ? 0 : POLLIN), 0});
+    bool unsent = false;
+    for (const Client& client : clients) {
+      short events = 0;
+      if (!stop && !client.closing && client.pending() < MAX_PENDING_OUTPUT) events |= POLLIN;
+      if (client.pending() > 0) events |= POLLOUT;
+      unsent = unsent || client.pending() > 0;
+      fds.push_back({client.fd, events, 0});
+    }
+    if (stop && !unsent) break;
+    int ready = poll(fds.data(), fds.size(), stop ? 1000 : -1);
+    if (ready < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    if (ready == 0) break;
+
+    for (size_t i = 0; i < clients.size(); i++) {
+      Client& client = clients[i];
+      const pollfd& polled = fds[i + 1];
+      bool open = true;
+      if ((polled.events & POLLIN) && (polled.revents & (POLLIN | POLLHUP | POLLERR))) open = readInput(client);
+      size_t newline;
+      while (open && !stop && (newline = client.input.find('\n')) != string::npos) {
+        string line = client.input.substr(0, newline);
+        client.input.erase(0, newline + 1);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        client.output += service.handle(line, stop) + "\n";
+      }
+      if (open && client.input.size() > MAX_LINE) {
+        client.output += "ERR request longer than " + to_string(MAX_LINE) + " bytes\n";
+        client.input.clear();
+        client.closing = true;
+      }
+      if (open && client.pending() > 0) open = writeOutput(client);
+      if (!open || (client.closing && client.pending() == 0)) {
+        close(client.fd);
+        client.fd = -1;
+      }
+    }
+    clients.erase(remove_if(clients.begin(), clients.end(), [](const Client& client) { return client.fd < 0; }), clients.end());
+
+    if (!stop && (fds[0].revents & POLLIN)) {
+      for (;;) {
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0) {
+          if (errno == EINTR || errno == ECONNABORTED) continue;
+          break;
+        }
+        if (!setNonBlocking(fd)) {
+          close(fd);
+          continue;
+        }
+        int yes = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+        clients.emplace_back(fd);
+      }
+    }
+  }
+
+  for (const Client& client : clients) close(client.fd);
+  close(listener);
+  if (address.compare(0, 10, "localhost:") != 0 && isSocket(address)) unlink(address.c_str());
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,26 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <string>
+
+// Keeps the loaded catalog and an incrementally maintained plan resident and
+// answers requests on a local socket, so replanning never reparses the input.
+// address is a Unix socket path or localhost:PORT. Requests and responses are
+// single lines; responses start with "OK" or "ERR". Clients may send many
+// requests before reading replies; a request line longer than 64 KiB ends
+// the connection. An existing socket file at the path is replaced only when
+// no server answers on it; any other file there makes the server fail.
+//
+//   commodity NAME                 -> OK demand= priority= cost= price= shortages=
+//   material NAME                  -> OK inventory= remaining= capacity= cost=
+//   update KIND:NAME:FIELD=VALUE   -> OK work=   (entries recomputed)
+//   total                          -> OK total=
+//   replan                         -> OK         (rebuilds the plan from scratch)
+//   allocate                       -> OK objective= iterations= warm=
+//   report                         -> OK         (writes the text report to out.txt)
+//   shutdown                       -> OK         (and the server exits)
+//
+// Returns the process exit status.
+int runServer(const std::string& address);
+
+#endif
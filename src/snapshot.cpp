@@ -0,0 +1,341 @@
+#include "snapshot.h"
+#include "catalog.h"
+#include "mapped_file.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+static_assert(sizeof(size_t) == sizeof(uint64_t), "snapshot row offsets are viewed as size_t");
+
+static const char SNAPSHOT_MAGIC[8] = {'P', 'L', 'A', 'N', 'S', 'N', 'A', 'P'};
+static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+static const uint64_t SECTION_ALIGNMENT = 64;
+
+enum Section {
+  MATERIAL_INVENTORY,
+  MATERIAL_CAPACITY,
+  MATERIAL_COST,
+  MATERIAL_NAMES,
+  COMMODITY_LABOR_REQUIRED,
+  COMMODITY_LABOR_AVAILABLE,
+  COMMODITY_DEMAND,
+  COMMODITY_PRIORITY,
+  COMMODITY_NAMES,
+  COMMODITY_WORKERS,
+  BOM_ROW_START,
+  BOM_MATERIAL_IDS,
+  BOM_USAGE_RATES,
+  INPUT_ROW_START,
+  INPUT_MATERIAL_IDS,
+  INPUT_AMOUNTS,
+  WORKER_HOURS,
+  WORKER_WAGE,
+  WORKER_NAMES,
+  MATERIAL_STRINGS,
+  COMMODITY_STRINGS,
+  WORKER_STRINGS,
+  SECTION_COUNT
+};
+
+struct SnapshotHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byteOrder;
+  uint64_t materials;
+  uint64_t commodities;
+  uint64_t entries;
+  uint64_t inputEntries;
+  uint64_t workers;
+  uint64_t materialStringBytes;
+  uint64_t commodityStringBytes;
+  uint64_t workerStringBytes;
+  uint64_t offset[SECTION_COUNT];
+  uint64_t size[SECTION_COUNT];
+};
+
+// Writes the snapshot to a temporary file beside the target and renames it
+// over the target once it is complete and synced. Readers map snapshots
+// MAP_SHARED and view the matrices in place, so a file that is in use must
+// never be truncated or rewritten; the rename leaves their mapping on the old
+// inode, which lives until the last mapping goes.
+class SnapshotWriter {
+public:
+  explicit SnapshotWriter(const string& path) : target(path), temporary(path + ".tmp." + to_string(getpid())) {
+    memset(&header, 0, sizeof(header));
+    int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW | O_CLOEXEC, 0666);
+    if (fd < 0) return;
+    out = fdopen(fd, "wb");
+    if (!out) {
+      close(fd);
+      unlink(temporary.c_str());
+      return;
+    }
+    write(&header, sizeof(header));
+  }
+
+  ~SnapshotWriter() {
+    if (out) {
+      fclose(out);
+      unlink(temporary.c_str());
+    }
+  }
+
+  SnapshotWriter(const SnapshotWriter&) = delete;
+  SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+  bool is_open() const { return out != nullptr; }
+
+  template <typename T>
+  void section(Section s, const T* data, size_t count) {
+    uint64_t padding = (SECTION_ALIGNMENT - position % SECTION_ALIGNMENT) % SECTION_ALIGNMENT;
+    static const char zeros[SECTION_ALIGNMENT] = {};
+    write(zeros, padding);
+    header.offset[s] = position;
+    header.size[s] = count * sizeof(T);
+    write(data, header.size[s]);
+  }
+
+  template <typename Array>
+  void section(Section s, const Array& data) { section(s, data.data(), data.size()); }
+
+  // Writes the header, syncs the file and renames it over the target.
+  bool finish() {
+    bool ok = !failed && fseek(out, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, out) == 1 && fflush(out) == 0 &&
+              fsync(fileno(out)) == 0;
+    ok = fclose(out) == 0 && ok;
+    out = nullptr;
+    if (ok && rename(temporary.c_str(), target.c_str()) == 0) return true;
+    unlink(temporary.c_str());
+    return false;
+  }
+
+  SnapshotHeader header;
+
+private:
+  string target;
+  string temporary;
+  FILE* out = nullptr;
+  uint64_t position = 0;
+  bool failed = false;
+
+  void write(const void* data, size_t size) {
+    if (size && fwrite(data, 1, size, out) != size) failed = true;
+    position += size;
+  }
+};
+
+bool writeSnapshot(const string& path, string& error) {
+  size_t materials = materialDatabase.size();
+  size_t commodities = commodityDatabase.size();
+  string materialStrings, commodityStrings, workerStrings;
+  vector<uint64_t> materialNames{0}, commodityNames{0}, workerNames{0}, commodityWorkers{0};
+  vector<double> inventory, capacity, demand, wage;
+  vector<float> cost;
+  vector<int32_t> laborRequired, laborAvailable, priority, hours;
+
+  for (const Materials& m : materialDatabase) {
+    materialStrings += m.name;
+    materialNames.push_back(materialStrings.size());
+    inventory.push_back(m.inventory);
+    capacity.push_back(m.production_capacity);
+    cost.push_back(m.cost);
+  }
+  for (const Commodity& c : commodityDatabase) {
+    commodityStrings += c.name;
+    commodityNames.push_back(commodityStrings.size());
+    laborRequired.push_back(c.laborRequired);
+    laborAvailable.push_back(c.laborAvailable);
+    demand.push_back(c.demand);
+    priority.push_back(c.priority);
+    for (const Worker& w : c.workers) {
+      workerStrings += w.name;
+      workerNames.push_back(workerStrings.size());
+      hours.push_back(w.hoursWorked);
+      wage.push_back(w.wage);
+    }
+    commodityWorkers.push_back(hours.size());
+  }
+
+  SnapshotWriter writer(path);
+  if (!writer.is_open()) {
+    error = "cannot write " + path;
+    return false;
+  }
+  SnapshotHeader& header = writer.header;
+  memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+  header.version = SNAPSHOT_VERSION;
+  header.byteOrder = BYTE_ORDER_MARK;
+  header.materials = materials;
+  header.commodities = commodities;
+  header.entries = billOfMaterials.materialIds.size();
+  header.inputEntries = materialInputs.materialIds.size();
+  header.workers = hours.size();
+  header.materialStringBytes = materialStrings.size();
+  header.commodityStringBytes = commodityStrings.size();
+  header.workerStringBytes = workerStrings.size();
+  writer.section(MATERIAL_INVENTORY, inventory);
+  writer.section(MATERIAL_CAPACITY, capacity);
+  writer.section(MATERIAL_COST, cost);
+  writer.section(MATERIAL_NAMES, materialNames);
+  writer.section(COMMODITY_LABOR_REQUIRED, laborRequired);
+  writer.section(COMMODITY_LABOR_AVAILABLE, laborAvailable);
+  writer.section(COMMODITY_DEMAND, demand);
+  writer.section(COMMODITY_PRIORITY, priority);
+  writer.section(COMMODITY_NAMES, commodityNames);
+  writer.section(COMMODITY_WORKERS, commodityWorkers);
+  writer.section(BOM_ROW_START, billOfMaterials.rowStart);
+  writer.section(BOM_MATERIAL_IDS, billOfMaterials.materialIds);
+  writer.section(BOM_USAGE_RATES, billOfMaterials.usageRates);
+  writer.section(INPUT_ROW_START, materialInputs.rowStart);
+  writer.section(INPUT_MATERIAL_IDS, materialInputs.materialIds);
+  writer.section(INPUT_AMOUNTS, materialInputs.usageRates);
+  writer.section(WORKER_HOURS, hours);
+  writer.section(WORKER_WAGE, wage);
+  writer.section(WORKER_NAMES, workerNames);
+  writer.section(MATERIAL_STRINGS, materialStrings.data(), materialStrings.size());
+  writer.section(COMMODITY_STRINGS, commodityStrings.data(), commodityStrings.size());
+  writer.section(WORKER_STRINGS, workerStrings.data(), workerStrings.size());
+  if (!writer.finish()) {
+    error = "error writing " + path;
+    return false;
+  }
+  return true;
+}
+
+// Typed view of one section, checked against the file bounds and the count
+// the header promises. Counts come from the file, so they are bounded by its
+// length before they are multiplied.
+template <typename T>
+static const T* sectionData(const MappedFile& file, const SnapshotHeader& header, Section s, uint64_t count) {
+  uint64_t length = static_cast<uint64_t>(file.end() - file.begin());
+  if (count > length / sizeof(T) || header.size[s] != count * sizeof(T) || header.offset[s] % SECTION_ALIGNMENT != 0 ||
+      header.offset[s] > length || header.size[s] > length - header.offset[s]) {
+    return nullptr;
+  }
+  return reinterpret_cast<const T*>(file.begin() + header.offset[s]);
+}
+
+// Offsets must start at 0, never decrease and stay within limit.
+static bool ascending(const uint64_t* offsets, uint64_t count, uint64_t limit) {
+  if (offsets[0] != 0 || offsets[count - 1] > limit) return false;
+  for (uint64_t i = 1; i < count; i++) {
+    if (offsets[i] < offsets[i - 1]) return false;
+  }
+  return true;
+}
+
+static bool validIds(const int32_t* ids, uint64_t count, uint64_t materials) {
+  for (uint64_t i = 0; i < count; i++) {
+    if (ids[i] < 0 || static_cast<uint64_t>(ids[i]) >= materials) return false;
+  }
+  return true;
+}
+
+bool loadSnapshot(const string& path, string& error) {
+  // The catalog matrices view the mapping, which lives as long as they do.
+  auto mapping = make_shared<const MappedFile>(path.c_str());
+  const MappedFile& file = *mapping;
+  if (!file.is_open()) {
+    error = "cannot open " + path;
+    return false;
+  }
+  SnapshotHeader header;
+  if (static_cast<size_t>(file.end() - file.begin()) < sizeof(header)) {
+    error = path + " is not a planner snapshot";
+    return false;
+  }
+  memcpy(&header, file.begin(), sizeof(header));
+  if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 || header.byteOrder != BYTE_ORDER_MARK) {
+    error = path + " is not a planner snapshot for this machine";
+    return false;
+  }
+  if (header.version != SNAPSHOT_VERSION) {
+    error = path + " has snapshot version " + to_string(header.version) + ", expected " + to_string(SNAPSHOT_VERSION);
+    return false;
+  }
+
+  // Every record takes at least one offset in the file, which also keeps the
+  // count + 1 of the offset arrays from wrapping.
+  uint64_t materials = header.materials, commodities = header.commodities;
+  uint64_t length = static_cast<uint64_t>(file.end() - file.begin());
+  if (materials >= length || commodities >= length || header.workers >= length) {
+    error = path + " is truncated or corrupt";
+    return false;
+  }
+  const double* inventory = sectionData<double>(file, header, MATERIAL_INVENTORY, materials);
+  const double* capacity = sectionData<double>(file, header, MATERIAL_CAPACITY, materials);
+  const float* cost = sectionData<float>(file, header, MATERIAL_COST, materials);
+  const uint64_t* materialNames = sectionData<uint64_t>(file, header, MATERIAL_NAMES, materials + 1);
+  const int32_t* laborRequired = sectionData<int32_t>(file, header, COMMODITY_LABOR_REQUIRED, commodities);
+  const int32_t* laborAvailable = sectionData<int32_t>(file, header, COMMODITY_LABOR_AVAILABLE, commodities);
+  const double* demand = sectionData<double>(file, header, COMMODITY_DEMAND, commodities);
+  const int32_t* priority = sectionData<int32_t>(file, header, COMMODITY_PRIORITY, commodities);
+  const uint64_t* commodityNames = sectionData<uint64_t>(file, header, COMMODITY_NAMES, commodities + 1);
+  const uint64_t* commodityWorkers = sectionData<uint64_t>(file, header, COMMODITY_WORKERS, commodities + 1);
+  const uint64_t* rowStart = sectionData<uint64_t>(file, header, BOM_ROW_START, commodities + 1);
+  const int32_t* materialIds = sectionData<int32_t>(file, header, BOM_MATERIAL_IDS, header.entries);
+  const double* usageRates = sectionData<double>(file, header, BOM_USAGE_RATES, header.entries);
+  const uint64_t* inputRowStart = sectionData<uint64_t>(file, header, INPUT_ROW_START, materials + 1);
+  const int32_t* inputIds = sectionData<int32_t>(file, header, INPUT_MATERIAL_IDS, header.inputEntries);
+  const double* inputAmounts = sectionData<double>(file, header, INPUT_AMOUNTS, header.inputEntries);
+  const int32_t* hours = sectionData<int32_t>(file, header, WORKER_HOURS, header.workers);
+  const double* wage = sectionData<double>(file, header, WORKER_WAGE, header.workers);
+  const uint64_t* workerNames = sectionData<uint64_t>(file, header, WORKER_NAMES, header.workers + 1);
+  const char* materialStrings = sectionData<char>(file, header, MATERIAL_STRINGS, header.materialStringBytes);
+  const char* commodityStrings = sectionData<char>(file, header, COMMODITY_STRINGS, header.commodityStringBytes);
+  const char* workerStrings = sectionData<char>(file, header, WORKER_STRINGS, header.workerStringBytes);
+  if (!inventory || !capacity || !cost || !materialNames || !laborRequired || !laborAvailable || !demand ||
+      !priority || !commodityNames || !commodityWorkers || !rowStart || !materialIds || !usageRates ||
+      !inputRowStart || !inputIds || !inputAmounts || !hours || !wage || !workerNames || !materialStrings || !commodityStrings || !workerStrings) {
+    error = path + " is truncated or corrupt";
+    return false;
+  }
+  if (!ascending(rowStart, commodities + 1, header.entries) || !ascending(inputRowStart, materials + 1, header.inputEntries) ||
+      !ascending(commodityWorkers, commodities + 1, header.workers) || !ascending(materialNames, materials + 1, header.materialStringBytes) ||
+      !ascending(commodityNames, commodities + 1, header.commodityStringBytes) || !ascending(workerNames, header.workers + 1, header.workerStringBytes) ||
+      !validIds(materialIds, header.entries, materials) || !validIds(inputIds, header.inputEntries, materials)) {
+    error = path + " is truncated or corrupt";
+    return false;
+  }
+
+  CatalogAllocationScope allocation;
+  materialDatabase.resize(materials);
+  for (uint64_t m = 0; m < materials; m++) {
+    Materials& material = materialDatabase[m];
+    material.name.assign(materialStrings + materialNames[m], materialNames[m + 1] - materialNames[m]);
+    material.inventory = inventory[m];
+    material.production_capacity = capacity[m];
+    material.cost = cost[m];
+  }
+  commodityDatabase.resize(commodities);
+  for (uint64_t c = 0; c < commodities; c++) {
+    Commodity& commodity = commodityDatabase[c];
+    commodity.name.assign(commodityStrings + commodityNames[c], commodityNames[c + 1] - commodityNames[c]);
+    commodity.laborRequired = laborRequired[c];
+    commodity.laborAvailable = laborAvailable[c];
+    commodity.demand = demand[c];
+    commodity.priority = priority[c];
+    commodity.workers.resize(commodityWorkers[c + 1] - commodityWorkers[c]);
+    for (uint64_t w = commodityWorkers[c]; w < commodityWorkers[c + 1]; w++) {
+      Worker& worker = commodity.workers[w - commodityWorkers[c]];
+      worker.name.assign(workerStrings + workerNames[w], workerNames[w + 1] - workerNames[w]);
+      worker.hoursWorked = hours[w];
+      worker.wage = wage[w];
+    }
+  }
+  billOfMaterials.rowStart.view(reinterpret_cast<const size_t*>(rowStart), commodities + 1, mapping);
+  billOfMaterials.materialIds.view(materialIds, header.entries, mapping);
+  billOfMaterials.usageRates.view(usageRates, header.entries, mapping);
+  materialInputs.rowStart.view(reinterpret_cast<const size_t*>(inputRowStart), materials + 1, mapping);
+  materialInputs.materialIds.view(inputIds, header.inputEntries, mapping);
+  materialInputs.usageRates.view(inputAmounts, header.inputEntries, mapping);
+  return true;
+}
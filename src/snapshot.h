@@ -0,0 +1,30 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <string>
+
+// Binary snapshot of the loaded catalog. All numeric data is stored as flat,
+// 64-byte aligned arrays in the same layout the planner uses (one array per
+// record field, the CSR bill of materials and technology matrix as-is, worker
+// arrays indexed through per-commodity offsets). Material, commodity and
+// worker names each live in one string table addressed by an offset array.
+// Loading maps the file without any parsing: the two CSR matrices view their
+// sections in place and keep the mapping alive until the catalog is released
+// or their rows change; record fields and names are copied into the records.
+//
+// Snapshots are replaced atomically and never changed in place: writeSnapshot
+// writes a temporary file in the target's directory, syncs it and renames it
+// over the target, so a process that has the old file mapped keeps reading
+// the old contents.
+//
+// Layout: SnapshotHeader, then the sections at the offsets it records. Files
+// are in host byte order; a byte-order mark in the header rejects foreign
+// ones. SNAPSHOT_VERSION changes whenever the layout does.
+
+#define SNAPSHOT_VERSION 1
+
+// Returns false and sets error on failure.
+bool writeSnapshot(const std::string& path, std::string& error);
+bool loadSnapshot(const std::string& path, std::string& error);
+
+#endif
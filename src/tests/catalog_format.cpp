@@ -0,0 +1,149 @@
+// Catalog files in every input format, named by extension or by the given
+// format, load the same catalog as the text JSON files; files of ambiguous
+// formats are refused instead of guessed, and material fields of the wrong
+// type are reported instead of thrown.
+#include "testing.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <nlohmann/json.hpp>
+
+using namespace std;
+using nlohmann::json;
+
+struct Loaded {
+  vector<string> names;
+  vector<double> numbers;
+};
+
+static Loaded load(bool useMmap, const string& materials, const string& commodities, CatalogFormat format) {
+  releaseCatalog();
+  loadData(useMmap, materials, commodities, 1, false, format);
+  Loaded loaded;
+  for (const Materials& m : materialDatabase) {
+    loaded.names.push_back(string(m.name));
+    loaded.numbers.insert(loaded.numbers.end(), {m.inventory, m.production_capacity, m.cost});
+  }
+  for (const Commodity& c : commodityDatabase) {
+    loaded.names.push_back(string(c.name));
+    loaded.numbers.insert(loaded.numbers.end(), {double(c.laborRequired), c.demand, double(c.priority)});
+  }
+  loaded.numbers.insert(loaded.numbers.end(), billOfMaterials.usageRates.begin(), billOfMaterials.usageRates.end());
+  return loaded;
+}
+
+static void writeBytes(const string& path, const vector<uint8_t>& bytes) {
+  ofstream(path, ios::binary).write(reinterpret_cast<const char*>(bytes.data()), static_cast<streamsize>(bytes.size()));
+}
+
+static vector<uint8_t> encode(const json& document, CatalogFormat format) {
+  switch (format) {
+    case CatalogFormat::Cbor: return json::to_cbor(document);
+    case CatalogFormat::MessagePack: return json::to_msgpack(document);
+    case CatalogFormat::Bson: return json::to_bson(document);
+    case CatalogFormat::Ubjson: return json::to_ubjson(document);
+    case CatalogFormat::BJData: return json::to_bjdata(document);
+    default: {
+      string text = document.dump(1);
+      return vector<uint8_t>(text.begin(), text.end());
+    }
+  }
+}
+
+// Exit status of loading the files in a child process, since the loader
+// exits on errors.
+static int loadStatus(const string& materials, const string& commodities) {
+  pid_t child = fork();
+  if (child == 0) {
+    freopen("/dev/null", "w", stderr);
+    loadData(false, materials, commodities);
+    _exit(0);
+  }
+  int status = 0;
+  waitpid(child, &status, 0);
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+int main() {
+  json materials = json::parse(ifstream("materials.json"));
+  json commodities = json::parse(ifstream("commodities.json"));
+  Loaded expected = load(false, "materials.json", "commodities.json", CatalogFormat::Detect);
+
+  struct Case {
+    const char* name;
+    CatalogFormat format;
+    const char* extension;
+  };
+  const Case cases[] = {
+      {"json", CatalogFormat::Json, ".json"},          {"cbor", CatalogFormat::Cbor, ".cbor"},
+      {"msgpack", CatalogFormat::MessagePack, ".msgpack"}, {"bson", CatalogFormat::Bson, ".bson"},
+      {"ubjson", CatalogFormat::Ubjson, ".ubj"},       {"bjdata", CatalogFormat::BJData, ".bjdata"},
+  };
+  for (const Case& c : cases) {
+    CatalogFormat parsed;
+    EXPECT(parseCatalogFormat(c.name, parsed) && parsed == c.format);
+    // BSON documents are objects, so the commodity array stays text JSON.
+    vector<uint8_t> commodityBytes = encode(commodities, c.format == CatalogFormat::Bson ? CatalogFormat::Json : c.format);
+    string materialFile = string("test_materials") + c.extension;
+    string commodityFile = string("test_commodities") + (c.format == CatalogFormat::Bson ? ".json" : c.extension);
+    writeBytes(materialFile, encode(materials, c.format));
+    writeBytes(commodityFile, commodityBytes);
+    for (bool useMmap : {false, true}) {
+      Loaded byExtension = load(useMmap, materialFile, commodityFile, CatalogFormat::Detect);
+      EXPECT(byExtension.names == expected.names && byExtension.numbers == expected.numbers);
+    }
+    remove(materialFile.c_str());
+    remove(commodityFile.c_str());
+    if (c.format == CatalogFormat::Bson) continue;
+
+    writeBytes("test_materials.bin", encode(materials, c.format));
+    writeBytes("test_commodities.bin", commodityBytes);
+    Loaded byName = load(false, "test_materials.bin", "test_commodities.bin", c.format);
+    EXPECT(byName.names == expected.names && byName.numbers == expected.numbers);
+  }
+  CatalogFormat unknown;
+  EXPECT(!parseCatalogFormat("xml", unknown));
+
+  // Without an extension, text JSON and tagged CBOR are recognized.
+  vector<uint8_t> tagged = json::to_cbor(materials), taggedCommodities = json::to_cbor(commodities);
+  tagged.insert(tagged.begin(), {0xd9, 0xd9, 0xf7});
+  taggedCommodities.insert(taggedCommodities.begin(), {0xd9, 0xd9, 0xf7});
+  writeBytes("test_materials.bin", tagged);
+  writeBytes("test_commodities.bin", taggedCommodities);
+  for (bool useMmap : {false, true}) {
+    Loaded sniffed = load(useMmap, "test_materials.bin", "test_commodities.bin", CatalogFormat::Detect);
+    EXPECT(sniffed.names == expected.names && sniffed.numbers == expected.numbers);
+  }
+  writeBytes("test_materials.bin", encode(materials, CatalogFormat::Json));
+  writeBytes("test_commodities.bin", encode(commodities, CatalogFormat::Json));
+  EXPECT(loadStatus("test_materials.bin", "test_commodities.bin") == 0);
+
+  // Untagged CBOR and MessagePack share type bytes and are refused.
+  writeBytes("test_materials.bin", json::to_msgpack(materials));
+  EXPECT(loadStatus("test_materials.bin", "test_commodities.bin") == EXIT_FAILURE);
+  writeBytes("test_materials.bin", json::to_cbor(materials));
+  EXPECT(loadStatus("test_materials.bin", "test_commodities.bin") == EXIT_FAILURE);
+
+  // A load that throws aborts the child instead of exiting with a failure.
+  const char* badMaterials[] = {
+      R"({"A": {"inventory": "10", "production_capacity": 1, "cost": 1}})",
+      R"({"A": {"inventory": 1, "production_capacity": null, "cost": 1}})",
+      R"({"A": {"inventory": 1, "production_capacity": 1, "cost": true}})",
+      R"({"A": {"inventory": 1, "production_capacity": 1}})",
+      R"({"A": [1, 2, 3]})",
+      R"([1])",
+      R"({"A": {"inventory": 1, "production_capacity": 1, "cost": 1, "inputs": {"B": "x"}}})",
+      R"({"A": {"inventory": 1, "production_capacity": 1, "cost": 1, "inputs": [1]}})",
+  };
+  for (const char* text : badMaterials) {
+    ofstream("test_materials.json") << text;
+    EXPECT(loadStatus("test_materials.json", "test_commodities.bin") == EXIT_FAILURE);
+  }
+
+  remove("test_materials.json");
+  remove("test_materials.bin");
+  remove("test_commodities.bin");
+  return testResult("catalog_format");
+}
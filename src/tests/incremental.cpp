@@ -0,0 +1,54 @@
+// IncrementalPlanner after random updates against planning the changed
+// catalog from scratch.
+#include "testing.h"
+#include "../incremental.h"
+#include "../pricing.h"
+
+using namespace std;
+
+static void expectMatchesFullReplan(const IncrementalPlanner& incremental) {
+  CatalogState start = CatalogState::capture();
+  Plan expected;
+  planSequential(expected);
+  CatalogState after = CatalogState::capture();
+  start.restore();
+
+  const Plan& plan = incremental.plan();
+  EXPECT(plan.order == expected.order);
+  EXPECT(sameBits(plan.shortage, expected.shortage));
+  EXPECT(sameBits(plan.commodityCost, expected.commodityCost));
+  vector<double> remaining;
+  for (size_t m = 0; m < materialDatabase.size(); m++) remaining.push_back(incremental.remainingInventory(static_cast<int>(m)));
+  EXPECT(sameBits(remaining, after.inventory));
+  vector<double> prices;
+  calculatePrices(prices);
+  EXPECT(sameBits(incremental.prices(), prices));
+}
+
+int main() {
+  mt19937 rng(9);
+  auto uniform = [&](int n) { return static_cast<int>(rng() % static_cast<unsigned>(n)); };
+  for (int trial = 0; trial < 30; trial++) {
+    randomCatalog(rng, 2 + trial % 20, 1 + uniform(200));
+    IncrementalPlanner incremental;
+    expectMatchesFullReplan(incremental);
+    for (int update = 0; update < 100; update++) {
+      int material = uniform(static_cast<int>(materialDatabase.size()));
+      int commodity = uniform(static_cast<int>(commodityDatabase.size()));
+      switch (uniform(5)) {
+        case 0: incremental.setMaterialInventory(material, uniform(4) == 0 ? 0.0 : uniform(2000) / 4.0); break;
+        case 1: incremental.setMaterialCapacity(material, uniform(500) / 8.0); break;
+        case 2: incremental.setMaterialCost(material, static_cast<float>(uniform(400)) / 16.0f); break;
+        case 3: incremental.setCommodityDemand(commodity, static_cast<double>(uniform(12) * 25)); break;
+        default: incremental.setCommodityPriority(commodity, uniform(14) - 1); break;
+      }
+      expectMatchesFullReplan(incremental);
+    }
+    EXPECT(incremental.applyUpdate("material:Material 0:inventory=12.5").empty());
+    EXPECT(materialDatabase[0].inventory == 12.5);
+    EXPECT(!incremental.applyUpdate("material:No such material:inventory=1").empty());
+    EXPECT(!incremental.applyUpdate("commodity:Commodity 0:colour=1").empty());
+    expectMatchesFullReplan(incremental);
+  }
+  return testResult("incremental");
+}
@@ -0,0 +1,48 @@
+// JSON Lines records for names that are not valid UTF-8, as binary inputs
+// and snapshots can carry: written with U+FFFD, and every line parses.
+#include "testing.h"
+#include "../plan_output.h"
+#include "../pricing.h"
+
+#include <sstream>
+#include <nlohmann/json.hpp>
+
+using namespace std;
+
+int main() {
+  mt19937 rng(17);
+  randomCatalog(rng, 10, 20, 4);
+  materialDatabase[0].name = "Ore \xff\xfe end";
+  for (size_t c = 0; c < commodityDatabase.size(); c++) {
+    if (c % 3 == 0) commodityDatabase[c].name = "Cut \xe2\x82";
+    if (!commodityDatabase[c].workers.empty()) commodityDatabase[c].workers[0].name = "\xc0\xaf";
+  }
+  vector<double> prices;
+  calculatePrices(prices);
+  Plan plan;
+  planSequential(plan);
+
+  ostringstream out;
+  bool threw = false;
+  try {
+    unique_ptr<PlanRecordWriter> writer = makeRecordWriter(OutputFormat::JsonLines, out, prices);
+    writePlanRecords(*writer, plan);
+  } catch (const nlohmann::json::exception&) {
+    threw = true;
+  }
+  EXPECT(!threw);
+
+  istringstream lines(out.str());
+  string line;
+  size_t records = 0;
+  bool replaced = false;
+  while (getline(lines, line)) {
+    nlohmann::json record = nlohmann::json::parse(line, nullptr, false);
+    EXPECT(!record.is_discarded());
+    replaced = replaced || line.find("\xef\xbf\xbd") != string::npos;
+    records++;
+  }
+  EXPECT(records == commodityDatabase.size() + 1);
+  EXPECT(replaced);
+  return testResult("json_lines");
+}
@@ -0,0 +1,121 @@
+// The lexer's bulk whitespace and string scanning against the byte-at-a-time
+// lexer. Only contiguous input is scanned in bulk; the same document read
+// through a std::istream takes the path a JSON_SIMD_SCAN=0 build uses for all
+// input, so both must give the same value, or the same error at the same
+// position. Escapes, control characters, quotes and multibyte UTF-8 are put
+// at every offset around the 16- and 32-byte block edges. Built once with the
+// default flags (SSE2 blocks) and once with -mavx2 (32-byte blocks).
+#include "testing.h"
+
+#include <sstream>
+#include <nlohmann/json.hpp>
+
+using namespace std;
+using nlohmann::json;
+
+#ifndef __AVX2__
+#define SCAN_NAME "json_scan"
+#else
+#define SCAN_NAME "json_scan_avx2"
+#endif
+
+// What parsing produced: the value as compact JSON, or the error message,
+// which includes the position.
+static string outcome(const string& text, bool contiguous) {
+  try {
+    if (contiguous) return json::parse(text.data(), text.data() + text.size()).dump();
+    istringstream in(text);
+    return json::parse(in).dump();
+  } catch (const json::exception& e) {
+    return string("error: ") + e.what();
+  }
+}
+
+static size_t referenceWhitespace(const string& text) {
+  size_t n = 0;
+  while (n < text.size() && (text[n] == ' ' || text[n] == '\t' || text[n] == '\n' || text[n] == '\r')) n++;
+  return n;
+}
+
+static size_t referencePlainString(const string& text) {
+  size_t n = 0;
+  while (n < text.size() && text[n] != '"' && text[n] != '\\' && static_cast<unsigned char>(text[n]) >= 0x20 &&
+         static_cast<unsigned char>(text[n]) < 0x80) {
+    n++;
+  }
+  return n;
+}
+
+int main() {
+#ifdef __AVX2__
+  if (!__builtin_cpu_supports("avx2")) {
+    cout << SCAN_NAME << ": skipped, no AVX2" << endl;
+    return 0;
+  }
+#endif
+  // The scanners themselves: one stop byte at every offset of runs longer
+  // than two blocks, and runs that end without one.
+  const string stops[] = {"\"", "\\", string(1, '\0'), "\x1f", "\x7f", "\x80", "\xc3", "\xff", "x", "\t"};
+  for (size_t length = 0; length <= 70; length++) {
+    for (size_t at = 0; at <= length; at++) {
+      for (const string& stop : stops) {
+        string plain(length, 'a');
+        string space(length, " \t\n\r"[at % 4]);
+        if (at < length) {
+          plain.replace(at, 1, stop);
+          space.replace(at, 1, stop);
+        }
+        EXPECT(nlohmann::detail::simd_scan::plain_string(plain.data(), plain.data() + plain.size()) == referencePlainString(plain));
+        EXPECT(nlohmann::detail::simd_scan::whitespace(space.data(), space.data() + space.size()) == referenceWhitespace(space));
+      }
+    }
+  }
+
+  // Whole documents. Specials sit inside strings after p plain bytes, which
+  // walks them across every block edge up to 70 bytes in, after runs of
+  // whitespace of every length.
+  const string specials[] = {
+      "\\n",          "\\\"",          "\\\\",       "\\/",       "\\u00e9",      "\\ud83d\\ude00", "\\ud83d",     "\\x",
+      "\\",           string(1, '\0'), "\x01",       "\t",        "\n",           "\x7f",           "\xc3\xa9",    "\xe2\x82\xac",
+      "\xf0\x9f\x98\x80", "\xc3",      "\xe2\x82",   "\xf0\x9f\x98", "\x80",      "\xc0\xaf",       "\xed\xa0\x80", "\xf4\x90\x80\x80",
+      "\"",           "\"\"",
+  };
+  const string spaces = " \t\n\r";
+  for (size_t p = 0; p <= 70; p++) {
+    for (const string& special : specials) {
+      for (size_t q : {size_t(0), size_t(1), size_t(15), size_t(33)}) {
+        string text = "[" + string(p % 7, ' ') + "\"" + string(p, 'a') + special + string(q, 'b') + "\"" + string(q % 3, '\n') + ", 1]";
+        EXPECT(outcome(text, true) == outcome(text, false));
+        // The same string as an object key, and cut off before it closes.
+        string key = "{\"" + string(p, 'k') + special + "\": " + string(q, ' ') + "true}";
+        EXPECT(outcome(key, true) == outcome(key, false));
+        string cut = "\"" + string(p, 'a') + special + string(q, 'b');
+        EXPECT(outcome(cut, true) == outcome(cut, false));
+      }
+    }
+    // Whitespace runs of length p, mixing line feeds so that the reported
+    // line and column depend on how the run was counted, ending in a value,
+    // in an error, or at the end of input.
+    string run;
+    for (size_t i = 0; i < p; i++) run += spaces[(i * 7 + p) % 4];
+    for (const string& after : {string("1"), string("x"), string(""), string("\"a\\q\""), string("[1,") + run + "}"}) {
+      string text = run + after + run;
+      EXPECT(outcome(text, true) == outcome(text, false));
+      string nested = "[" + run + after + run + "]";
+      EXPECT(outcome(nested, true) == outcome(nested, false));
+    }
+  }
+
+  // Long strings of mixed content, each piece at a random offset.
+  mt19937 rng(14);
+  for (int round = 0; round < 2000; round++) {
+    string text = "{\"s\":" + string(rng() % 40, ' ') + "\"";
+    for (size_t n = rng() % 12; n > 0; n--) {
+      text += string(rng() % 40, 'a' + static_cast<char>(rng() % 26));
+      text += specials[rng() % (sizeof(specials) / sizeof(specials[0]))];
+    }
+    text += "\"" + string(rng() % 40, "\n \t\r"[rng() % 4]) + "}";
+    EXPECT(outcome(text, true) == outcome(text, false));
+  }
+  return testResult(SCAN_NAME);
+}
@@ -0,0 +1,73 @@
+// Gross output from the threaded Jacobi solver: the same bits on any number
+// of threads, and a residual that is (I - A)x - d of the returned x.
+#include "testing.h"
+#include "../leontief.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+// Random technology matrix whose rows use up to 0.9 of a unit in total, so
+// it is productive.
+static void randomInputs(mt19937& rng, int materials) {
+  materialInputs = BillOfMaterials();
+  vector<int> ids;
+  vector<double> amounts;
+  for (int m = 0; m < materials; m++) {
+    ids.clear();
+    amounts.clear();
+    int count = static_cast<int>(rng() % 5);
+    for (int e = 0; e < count; e++) {
+      int input = static_cast<int>(rng() % static_cast<unsigned>(materials));
+      if (find(ids.begin(), ids.end(), input) != ids.end()) continue;
+      ids.push_back(input);
+      amounts.push_back(0.9 / 5 * (rng() % 1000) / 1000.0);
+    }
+    materialInputs.appendRow(ids, amounts);
+  }
+}
+
+// Largest element of (I - A)x - d, where row m of materialInputs gives what
+// producing one unit of m consumes of each input.
+static double residual(const vector<double>& x, const vector<double>& d) {
+  vector<double> r(x.size());
+  for (size_t m = 0; m < x.size(); m++) r[m] = x[m] - d[m];
+  for (size_t m = 0; m < x.size(); m++) {
+    for (size_t e = materialInputs.rowBegin(static_cast<int>(m)); e < materialInputs.rowEnd(static_cast<int>(m)); e++) {
+      r[materialInputs.materialIds[e]] -= materialInputs.usageRates[e] * x[m];
+    }
+  }
+  double largest = 0.0;
+  for (double element : r) largest = max(largest, fabs(element));
+  return largest;
+}
+
+int main() {
+  mt19937 rng(7);
+  for (int round = 0; round < 40; round++) {
+    int materials = 1 + static_cast<int>(rng() % 300);
+    randomCatalog(rng, materials, static_cast<int>(rng() % 100));
+    randomInputs(rng, materials);
+    vector<double> demand = directMaterialDemand();
+
+    LeontiefSolution one = solveGrossOutput(demand, 1);
+    EXPECT(one.converged);
+    double scale = max(1.0, demand.empty() ? 0.0 : *max_element(demand.begin(), demand.end()));
+    EXPECT(one.residual <= 1e-12 * scale);
+    double largest = 1.0;
+    for (double output : one.grossOutput) largest = max(largest, output);
+    EXPECT(fabs(residual(one.grossOutput, demand) - one.residual) <= 1e-14 * largest);
+    for (unsigned threads : {2u, 3u, 8u}) {
+      LeontiefSolution many = solveGrossOutput(demand, threads);
+      EXPECT(many.iterations == one.iterations);
+      EXPECT(sameBits(many.residual, one.residual));
+      EXPECT(sameBits(many.grossOutput, one.grossOutput));
+    }
+
+    LeontiefSolution cut = solveGrossOutput(demand, 3, 1e-12, 2);
+    EXPECT(cut.iterations <= 2);
+    if (!cut.converged) EXPECT(cut.residual > 1e-12 * scale);
+  }
+  return testResult("leontief");
+}
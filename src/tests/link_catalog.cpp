@@ -0,0 +1,122 @@
+// The link step after loading: undefined materials, material inputs and usage
+// rates and repeated commodity names are reported together, on the serial and
+// the parallel loader, and a failed link leaves no catalog behind. With
+// allowUndefinedMaterials, undefined materials become empty records.
+#include "testing.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+static const char* MATERIALS = "test_link_materials.json";
+static const char* COMMODITIES = "test_link_commodities.json";
+static const char* ERRORS = "test_link_errors.txt";
+
+static string commodity(const string& name, const vector<string>& materials, const vector<string>& rated) {
+  string text = "{\"name\": \"" + name + "\", \"materialNames\": [";
+  for (size_t k = 0; k < materials.size(); k++) text += (k ? ", \"" : "\"") + materials[k] + "\"";
+  text += "], \"usageRates\": {";
+  for (size_t k = 0; k < rated.size(); k++) text += (k ? ", \"" : "\"") + rated[k] + "\": 0.5";
+  return text + "}, \"laborRequired\": 2, \"laborAvailable\": 100, \"demand\": 10, \"priority\": 3, \"workers\": []}";
+}
+
+static void writeCatalog(const string& materials, const vector<string>& commodities) {
+  ofstream(MATERIALS) << materials;
+  ofstream out(COMMODITIES);
+  out << "[\n";
+  for (size_t c = 0; c < commodities.size(); c++) out << commodities[c] << (c + 1 < commodities.size() ? ",\n" : "\n");
+  out << "]\n";
+}
+
+static const char* const DEFINED = "{\"Wood\": {\"inventory\": 5, \"production_capacity\": 1, \"cost\": 2},"
+                                   " \"Iron\": {\"inventory\": 7, \"production_capacity\": 0, \"cost\": 3}}";
+
+// Whether the catalog was released when the loader exited.
+static void exitedWithCatalog() {
+  _exit(materialDatabase.empty() && commodityDatabase.empty() && billOfMaterials.materialIds.empty() ? 1 : 2);
+}
+
+// Loads in a child process, since a failed link exits. Returns the exit
+// status: 0 when loading succeeded, 1 when it failed and released the
+// catalog, 2 when it failed and left records behind. errors gets stderr.
+static int loadStatus(unsigned threads, string& errors) {
+  pid_t child = fork();
+  if (child == 0) {
+    freopen(ERRORS, "w", stderr);
+    atexit(exitedWithCatalog);
+    loadData(false, MATERIALS, COMMODITIES, threads);
+    _exit(0);
+  }
+  int status = 0;
+  waitpid(child, &status, 0);
+  ifstream in(ERRORS);
+  errors.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+static bool contains(const string& text, const string& part) {
+  return text.find(part) != string::npos;
+}
+
+int main() {
+  string errors;
+  for (unsigned threads : {1u, 4u}) {
+    // A commodity naming a material that materials.json lacks.
+    writeCatalog(DEFINED, {commodity("Chair", {"Wood", "Glue"}, {"Wood", "Glue"}), commodity("Table", {"Iron"}, {"Iron"})});
+    EXPECT(loadStatus(threads, errors) == 1);
+    EXPECT(contains(errors, "(1):"));
+    EXPECT(contains(errors, "'Chair' uses material 'Glue', which " + string(MATERIALS) + " does not define"));
+
+    // A commodity name given twice.
+    writeCatalog(DEFINED, {commodity("Chair", {"Wood"}, {"Wood"}), commodity("Table", {"Iron"}, {"Iron"}),
+                           commodity("Chair", {"Iron"}, {"Iron"})});
+    EXPECT(loadStatus(threads, errors) == 1);
+    EXPECT(contains(errors, "(1):"));
+    EXPECT(contains(errors, "commodity 'Chair' is defined more than once"));
+
+    // Every problem at once, including a material input that is not defined
+    // and usage rates that do not match the material names.
+    writeCatalog("{\"Wood\": {\"inventory\": 5, \"production_capacity\": 1, \"cost\": 2, \"inputs\": {\"Sap\": 1}}}",
+                 {commodity("Chair", {"Wood"}, {"Wood"}), commodity("Chair", {"Wood", "Nails"}, {"Wood", "Nails"}),
+                  commodity("Stool", {"Wood"}, {"Varnish"})});
+    EXPECT(loadStatus(threads, errors) == 1);
+    EXPECT(contains(errors, "(5):"));
+    EXPECT(contains(errors, "'Chair' uses material 'Nails'"));
+    EXPECT(contains(errors, "commodity 'Chair' is defined more than once"));
+    EXPECT(contains(errors, "'Wood' lists input 'Sap'"));
+    EXPECT(contains(errors, "no usage rate for 'Wood' in 'Stool'"));
+    EXPECT(contains(errors, "usage rate for 'Varnish' in 'Stool' names no entry of its materialNames"));
+
+    // A clean catalog links.
+    writeCatalog(DEFINED, {commodity("Chair", {"Wood", "Iron"}, {"Wood", "Iron"}), commodity("Table", {"Iron"}, {"Iron"})});
+    EXPECT(loadStatus(threads, errors) == 0);
+    EXPECT(errors.empty());
+  }
+
+  // Undefined materials allowed: a warning, and a complete empty record.
+  writeCatalog(DEFINED, {commodity("Chair", {"Wood", "Glue"}, {"Wood", "Glue"}), commodity("Table", {"Iron"}, {"Iron"})});
+  releaseCatalog();
+  streambuf* previous = cerr.rdbuf(nullptr);
+  loadData(false, MATERIALS, COMMODITIES, 1, true);
+  cerr.clear();
+  cerr.rdbuf(previous);
+  EXPECT(materialDatabase.size() == 3 && commodityDatabase.size() == 2);
+  int glue = findMaterial("Glue");
+  EXPECT(glue >= 0);
+  if (glue >= 0) {
+    EXPECT(materialDatabase[glue].inventory == 0.0 && materialDatabase[glue].production_capacity == 0.0 && materialDatabase[glue].cost == 0.0f);
+  }
+  for (int id : billOfMaterials.materialIds) EXPECT(id >= 0 && static_cast<size_t>(id) < materialDatabase.size());
+  EXPECT(billOfMaterials.rows() == commodityDatabase.size() && materialInputs.rows() == materialDatabase.size());
+  releaseCatalog();
+
+  remove(MATERIALS);
+  remove(COMMODITIES);
+  remove(ERRORS);
+  return testResult("link_catalog");
+}
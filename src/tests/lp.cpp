@@ -0,0 +1,135 @@
+// AllocationLP against a dense textbook simplex on random catalogs, and warm
+// starts against solving the changed catalog from scratch.
+#include <algorithm>
+#include <cmath>
+
+#include "testing.h"
+#include "../lp.h"
+
+using namespace std;
+
+static double upperBound(const Commodity& commodity) {
+  double bound = max(0.0, commodity.demand);
+  if (commodity.laborRequired > 0) bound = min(bound, max(0.0, static_cast<double>(commodity.laborAvailable) / commodity.laborRequired));
+  return bound;
+}
+
+// max c'x  s.t.  Ax <= b, x <= upper, x >= 0  with the bounds as extra rows,
+// a full tableau whose last row holds the reduced costs, and Bland's rule
+// throughout.
+static double referenceObjective() {
+  size_t n = commodityDatabase.size(), materials = materialDatabase.size(), m = materials + n;
+  size_t width = n + m + 1;
+  vector<double> tableau((m + 1) * width, 0.0);
+  vector<size_t> basis(m);
+  double* reduced = &tableau[m * width];
+  for (size_t c = 0; c < n; c++) {
+    for (size_t e = billOfMaterials.rowBegin(c); e < billOfMaterials.rowEnd(c); e++) {
+      tableau[billOfMaterials.materialIds[e] * width + c] += billOfMaterials.usageRates[e];
+    }
+    tableau[(materials + c) * width + c] = 1.0;
+    reduced[c] = priorityWeight(commodityDatabase[c].priority);
+  }
+  for (size_t r = 0; r < m; r++) {
+    tableau[r * width + n + r] = 1.0;
+    tableau[r * width + n + m] = r < materials ? max(0.0, materialDatabase[r].inventory + materialDatabase[r].production_capacity)
+                                               : upperBound(commodityDatabase[r - materials]);
+    basis[r] = n + r;
+  }
+  while (true) {
+    size_t entering = n + m;
+    for (size_t j = 0; j < n + m && entering == n + m; j++) {
+      if (reduced[j] > 1e-9) entering = j;
+    }
+    if (entering == n + m) break;
+    size_t leaving = m;
+    double best = 0.0;
+    for (size_t r = 0; r < m; r++) {
+      double alpha = tableau[r * width + entering];
+      if (alpha <= 1e-9) continue;
+      double ratio = tableau[r * width + n + m] / alpha;
+      if (leaving == m || ratio < best || (ratio == best && basis[r] < basis[leaving])) {
+        leaving = r;
+        best = ratio;
+      }
+    }
+    double pivot = tableau[leaving * width + entering];
+    for (size_t j = 0; j < width; j++) tableau[leaving * width + j] /= pivot;
+    for (size_t r = 0; r <= m; r++) {
+      double factor = tableau[r * width + entering];
+      if (r == leaving || factor == 0.0) continue;
+      for (size_t j = 0; j < width; j++) tableau[r * width + j] -= factor * tableau[leaving * width + j];
+    }
+    basis[leaving] = entering;
+  }
+  return -reduced[n + m];
+}
+
+static bool close(double a, double b) {
+  return fabs(a - b) <= 1e-7 * max(1.0, fabs(b));
+}
+
+static void expectFeasible(const Allocation& allocation) {
+  EXPECT(allocation.optimal);
+  EXPECT(allocation.fulfilled.size() == commodityDatabase.size());
+  EXPECT(allocation.materialUsed.size() == materialDatabase.size());
+  for (size_t c = 0; c < commodityDatabase.size(); c++) {
+    EXPECT(allocation.fulfilled[c] >= -1e-7);
+    EXPECT(allocation.fulfilled[c] <= upperBound(commodityDatabase[c]) + 1e-7);
+  }
+  for (size_t m = 0; m < materialDatabase.size(); m++) {
+    double available = max(0.0, materialDatabase[m].inventory + materialDatabase[m].production_capacity);
+    EXPECT(allocation.materialUsed[m] <= available + 1e-7 * max(1.0, available));
+  }
+}
+
+int main() {
+  mt19937 rng(13);
+  auto uniform = [&](int n) { return static_cast<int>(rng() % static_cast<unsigned>(n)); };
+  int warmIterations = 0, coldIterations = 0;
+  for (int trial = 0; trial < 40; trial++) {
+    // The larger catalogs take well over a refactorization interval of pivots.
+    int materials = trial % 4 == 3 ? 60 : 1 + uniform(15);
+    int commodities = trial % 4 == 3 ? 300 : 1 + uniform(60);
+    randomCatalog(rng, materials, commodities);
+    AllocationLP allocator;
+    Allocation cold = allocator.solve();
+    expectFeasible(cold);
+    EXPECT(!cold.warmStarted);
+    EXPECT(close(cold.objective, referenceObjective()));
+
+    Allocation again = allocator.solve();
+    EXPECT(again.warmStarted);
+    EXPECT(again.iterations == 0);
+    for (size_t c = 0; c < cold.fulfilled.size(); c++) EXPECT(close(again.fulfilled[c], cold.fulfilled[c]));
+
+    for (int update = 0; update < 10; update++) {
+      int material = uniform(materials);
+      int commodity = uniform(commodities);
+      switch (uniform(3)) {
+        case 0: materialDatabase[material].inventory = uniform(4) == 0 ? 0.0 : uniform(2000) / 4.0; break;
+        case 1: commodityDatabase[commodity].demand = static_cast<double>(uniform(12) * 25); break;
+        default: commodityDatabase[commodity].priority = uniform(14) - 1; break;
+      }
+      Allocation warm = allocator.solve();
+      Allocation fresh = AllocationLP().solve();
+      expectFeasible(warm);
+      expectFeasible(fresh);
+      EXPECT(close(warm.objective, fresh.objective));
+      if (update % 5 == 4) EXPECT(close(warm.objective, referenceObjective()));
+      if (warm.warmStarted) {
+        warmIterations += warm.iterations;
+        coldIterations += fresh.iterations;
+      }
+    }
+
+    // A basis for other dimensions is not reused.
+    randomCatalog(rng, materials + 1, commodities);
+    Allocation resized = allocator.solve();
+    expectFeasible(resized);
+    EXPECT(!resized.warmStarted);
+    EXPECT(close(resized.objective, referenceObjective()));
+  }
+  EXPECT(warmIterations < coldIterations);
+  return testResult("lp");
+}
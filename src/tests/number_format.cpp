@@ -0,0 +1,55 @@
+// formatNumber output against strtod round trips, and the --precision bounds
+// that keep it inside NUMBER_BUFFER.
+#include "testing.h"
+#include "../number_format.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+using namespace std;
+
+static double readBack(const char* text, size_t length) {
+  return strtod(string(text, length).c_str(), nullptr);
+}
+
+int main() {
+  mt19937_64 rng(18);
+  char buffer[NUMBER_BUFFER + 8];
+  for (int i = 0; i < 100000; i++) {
+    uint64_t bits = rng();
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    if (!isfinite(value)) continue;
+    size_t length = formatNumber(buffer, value);
+    EXPECT(length < NUMBER_BUFFER);
+    EXPECT(sameBits(readBack(buffer, length), value));
+    length = formatNumber(buffer, value, MAX_PRECISION);
+    EXPECT(length < NUMBER_BUFFER);
+    EXPECT(sameBits(readBack(buffer, length), value));
+  }
+
+  // Precision beyond what fits used to report the untruncated length, and
+  // operator<< then wrote stack memory past the buffer.
+  for (int precision : {30, 40, 400}) {
+    size_t length = formatNumber(buffer, 1.0 / 3.0, precision);
+    EXPECT(length == NUMBER_BUFFER - 1);
+    ostringstream out;
+    out << FormattedNumber{-DBL_MAX, precision};
+    EXPECT(out.str().size() < NUMBER_BUFFER);
+    EXPECT(out.str().find('\0') == string::npos);
+  }
+
+  int precision = 0;
+  EXPECT(parsePrecision("1", precision) && precision == 1);
+  EXPECT(parsePrecision("17", precision) && precision == 17);
+  EXPECT(!parsePrecision("0", precision));
+  EXPECT(!parsePrecision("18", precision));
+  EXPECT(!parsePrecision("40", precision));
+  EXPECT(!parsePrecision("-3", precision));
+  EXPECT(!parsePrecision("6x", precision));
+  EXPECT(!parsePrecision("", precision));
+  EXPECT(!parsePrecision("99999999999999999999", precision));
+  return testResult("number_format");
+}
@@ -0,0 +1,142 @@
+// Loading a commodities file on several threads, from a stream and from a
+// mapping, gives the same catalog as the serial loader. Names are full of
+// brackets, braces, commas and escaped quotes and backslashes, so the pre-scan
+// that splits the array has to track strings, and chunk boundaries fall
+// inside such strings.
+#include "testing.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+using namespace std;
+
+// Everything the loader fills in, as plain values.
+struct Loaded {
+  vector<string> names;
+  vector<double> numbers;
+  vector<int> ids;
+  vector<size_t> rowStart;
+
+  bool operator==(const Loaded& other) const {
+    return names == other.names && sameBits(numbers, other.numbers) && ids == other.ids && rowStart == other.rowStart;
+  }
+};
+
+static Loaded load(bool useMmap, unsigned threads, const string& materials, const string& commodities) {
+  releaseCatalog();
+  loadData(useMmap, materials, commodities, threads);
+  Loaded loaded;
+  for (const Materials& m : materialDatabase) {
+    loaded.names.push_back(string(m.name));
+    loaded.numbers.insert(loaded.numbers.end(), {m.inventory, m.production_capacity, m.cost});
+  }
+  for (const Commodity& c : commodityDatabase) {
+    loaded.names.push_back(string(c.name));
+    loaded.numbers.insert(loaded.numbers.end(), {double(c.laborRequired), double(c.laborAvailable), c.demand, double(c.priority)});
+    for (const Worker& w : c.workers) {
+      loaded.names.push_back(string(w.name));
+      loaded.numbers.insert(loaded.numbers.end(), {double(w.hoursWorked), w.wage});
+    }
+  }
+  loaded.numbers.insert(loaded.numbers.end(), billOfMaterials.usageRates.begin(), billOfMaterials.usageRates.end());
+  loaded.ids.assign(billOfMaterials.materialIds.begin(), billOfMaterials.materialIds.end());
+  loaded.rowStart.assign(billOfMaterials.rowStart.begin(), billOfMaterials.rowStart.end());
+  return loaded;
+}
+
+static string quoted(const string& text) {
+  string out = "\"";
+  for (char ch : text) {
+    if (ch == '"' || ch == '\\') out += '\\';
+    out += ch;
+  }
+  return out + "\"";
+}
+
+// A unique name of some length made mostly of characters the pre-scan must
+// not take for structure, including UTF-8 and runs of backslashes before a
+// quote.
+static string trickyName(mt19937& rng, const string& prefix, size_t index, size_t length) {
+  static const char* pieces[] = {"[", "]", "{", "}", ",", "\"", "\\", "\\\"", "\\\\\"", ":", " ", "\xc3\xa9", "x"};
+  string name = prefix + " " + to_string(index) + " ";
+  while (name.size() < length) name += pieces[rng() % (sizeof(pieces) / sizeof(pieces[0]))];
+  return name;
+}
+
+int main() {
+  const string materialPath = "test_parallel_materials.json", commodityPath = "test_parallel_commodities.json";
+  mt19937 rng(14);
+  const unsigned threadCounts[] = {2, 3, 4, 7, 16};
+
+  for (int round = 0; round < 6; round++) {
+    size_t materials = 1 + rng() % 30;
+    size_t commodities = round == 0 ? 1 : 20 + rng() % 200;
+    vector<string> materialNames;
+    ofstream materialFile(materialPath);
+    materialFile << "{\n";
+    for (size_t m = 0; m < materials; m++) {
+      materialNames.push_back(trickyName(rng, "Material", m, 10 + rng() % 40));
+      materialFile << "  " << quoted(materialNames[m]) << ": {\"inventory\": " << rng() % 1000 << ", \"production_capacity\": " << rng() % 300
+                   << ", \"cost\": " << (rng() % 400) / 16.0 << "}" << (m + 1 < materials ? ",\n" : "\n");
+    }
+    materialFile << "}\n";
+    materialFile.close();
+
+    // Spans of the commodity name strings, to see where chunks split.
+    string text = "[";
+    vector<pair<size_t, size_t>> nameSpans;
+    for (size_t c = 0; c < commodities; c++) {
+      string name = quoted(trickyName(rng, "Commodity", c, 20 + rng() % 400));
+      text += c ? ",\n {\"name\": " : "\n {\"name\": ";
+      nameSpans.emplace_back(text.size(), text.size() + name.size());
+      text += name + ", \"materialNames\": [";
+      vector<size_t> used;
+      for (size_t k = rng() % 5; k > 0; k--) {
+        size_t m = rng() % materials;
+        if (find(used.begin(), used.end(), m) == used.end()) used.push_back(m);
+      }
+      string rates;
+      for (size_t k = 0; k < used.size(); k++) {
+        text += (k ? ", " : "") + quoted(materialNames[used[k]]);
+        rates += (k ? ", " : "") + quoted(materialNames[used[k]]) + ": " + to_string((rng() % 64) / 16.0 + 0.1);
+      }
+      text += "], \"usageRates\": {" + rates + "}, \"laborRequired\": " + to_string(1 + rng() % 20) +
+              ", \"laborAvailable\": " + to_string(rng() % 2000) + ", \"demand\": " + to_string(rng() % 300) +
+              ", \"priority\": " + to_string(rng() % 14) + ", \"workers\": [";
+      for (size_t w = 0, workers = rng() % 3; w < workers; w++) {
+        text += (w ? ", " : "") + string("{\"name\": ") + quoted(trickyName(rng, "Worker", w, 8 + rng() % 30)) +
+                ", \"hoursWorked\": " + to_string(rng() % 60) + ", \"wage\": 0}";
+      }
+      text += "]}";
+    }
+    text += "\n]\n";
+    ofstream(commodityPath, ios::binary) << text;
+
+    Loaded expected = load(false, 1, materialPath, commodityPath);
+    EXPECT(commodityLoadThreads() == 1);
+    EXPECT(commodityDatabase.size() == commodities);
+
+    bool splitInString = false;
+    for (unsigned threads : threadCounts) {
+      for (bool useMmap : {false, true}) {
+        Loaded loaded = load(useMmap, threads, materialPath, commodityPath);
+        if (commodities > 1) {
+          EXPECT(commodityLoadThreads() > 1 && commodityLoadThreads() <= threads);
+        } else {
+          EXPECT(commodityLoadThreads() == 1);
+        }
+        EXPECT(loaded == expected);
+      }
+      // The byte offsets the loader aims its chunk boundaries at.
+      for (unsigned k = 1; k < threads; k++) {
+        size_t target = text.size() * k / threads;
+        for (const auto& span : nameSpans) splitInString = splitInString || (span.first < target && target < span.second);
+      }
+    }
+    if (commodities > 1) EXPECT(splitInString);
+  }
+  remove(materialPath.c_str());
+  remove(commodityPath.c_str());
+  return testResult("parallel_load");
+}
@@ -0,0 +1,29 @@
+// planParallel on several thread counts against planSequential.
+#include "testing.h"
+#include "../planner.h"
+
+using namespace std;
+
+int main() {
+  mt19937 rng(6);
+  for (int trial = 0; trial < 60; trial++) {
+    randomCatalog(rng, 1 + trial % 30, static_cast<int>(rng() % 400));
+    CatalogState start = CatalogState::capture();
+    Plan expected;
+    planSequential(expected);
+    CatalogState after = CatalogState::capture();
+
+    for (unsigned threads : {2u, 3u, 8u}) {
+      start.restore();
+      Plan plan;
+      planParallel(plan, threads);
+      CatalogState state = CatalogState::capture();
+      EXPECT(plan.order == expected.order);
+      EXPECT(sameBits(plan.shortage, expected.shortage));
+      EXPECT(sameBits(plan.commodityCost, expected.commodityCost));
+      EXPECT(sameBits(state.inventory, after.inventory));
+      EXPECT(sameBits(state.wages, after.wages));
+    }
+  }
+  return testResult("parallel_plan");
+}
@@ -0,0 +1,21 @@
+// Batch pricing at every SIMD level the CPU supports against calculatePrice.
+#include "testing.h"
+#include "../pricing.h"
+
+using namespace std;
+
+int main() {
+  mt19937 rng(5);
+  SimdLevel widest = detectSimdLevel();
+  for (int trial = 0; trial < 50; trial++) {
+    randomCatalog(rng, 1 + trial % 40, static_cast<int>(rng() % 300), 1 + trial % 12);
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512}) {
+      if (level > widest) break;
+      vector<double> prices;
+      calculatePrices(prices, level);
+      EXPECT(prices.size() == commodityDatabase.size());
+      for (size_t c = 0; c < prices.size(); c++) EXPECT(sameBits(prices[c], calculatePrice(static_cast<int>(c))));
+    }
+  }
+  return testResult("pricing");
+}
@@ -0,0 +1,29 @@
+// planScan on several thread counts against planSequential.
+#include "testing.h"
+#include "../planner.h"
+
+using namespace std;
+
+int main() {
+  mt19937 rng(21);
+  for (int trial = 0; trial < 100; trial++) {
+    randomCatalog(rng, 1 + trial % 50, static_cast<int>(rng() % 500), 1 + trial % 10);
+    CatalogState start = CatalogState::capture();
+    Plan expected;
+    planSequential(expected);
+    CatalogState after = CatalogState::capture();
+
+    for (unsigned threads : {1u, 2u, 5u}) {
+      start.restore();
+      Plan plan;
+      planScan(plan, threads);
+      CatalogState state = CatalogState::capture();
+      EXPECT(plan.order == expected.order);
+      EXPECT(sameBits(plan.shortage, expected.shortage));
+      EXPECT(sameBits(plan.commodityCost, expected.commodityCost));
+      EXPECT(sameBits(state.inventory, after.inventory));
+      EXPECT(sameBits(state.wages, after.wages));
+    }
+  }
+  return testResult("scan_plan");
+}
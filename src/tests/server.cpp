@@ -0,0 +1,143 @@
+// The request server over a Unix socket: pipelined requests, overlong lines,
+// report paths chosen by a client, and what it does with an existing file at
+// its path.
+#include "testing.h"
+#include "../server.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+static const char* PATH = "test_server.sock";
+
+static sockaddr_un socketAddress() {
+  sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, PATH);
+  return addr;
+}
+
+static int connectToServer() {
+  sockaddr_un addr = socketAddress();
+  for (int attempt = 0; attempt < 500; attempt++) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) return fd;
+    close(fd);
+    usleep(10000);
+  }
+  return -1;
+}
+
+static bool sendAll(int fd, const string& data) {
+  size_t written = 0;
+  while (written < data.size()) {
+    ssize_t n = write(fd, data.data() + written, data.size() - written);
+    if (n <= 0) return false;
+    written += static_cast<size_t>(n);
+  }
+  return true;
+}
+
+// Reads replies until count lines or the end of the connection.
+static vector<string> readLines(int fd, size_t count) {
+  vector<string> lines;
+  string buffer;
+  char chunk[4096];
+  while (lines.size() < count) {
+    ssize_t n = read(fd, chunk, sizeof(chunk));
+    if (n <= 0) break;
+    buffer.append(chunk, static_cast<size_t>(n));
+    size_t newline;
+    while ((newline = buffer.find('\n')) != string::npos) {
+      lines.push_back(buffer.substr(0, newline));
+      buffer.erase(0, newline + 1);
+    }
+  }
+  return lines;
+}
+
+// runServer with its expected error message kept off the test output.
+static int runServerQuietly() {
+  streambuf* previous = cerr.rdbuf(nullptr);
+  int status = runServer(PATH);
+  cerr.clear();
+  cerr.rdbuf(previous);
+  return status;
+}
+
+static bool isSocket() {
+  struct stat st;
+  return lstat(PATH, &st) == 0 && S_ISSOCK(st.st_mode);
+}
+
+int main() {
+  mt19937 rng(10);
+  randomCatalog(rng, 20, 30);
+  unlink(PATH);
+
+  // A regular file at the path is neither removed nor replaced.
+  ofstream(PATH) << "keep";
+  EXPECT(runServerQuietly() == EXIT_FAILURE);
+  EXPECT(!isSocket());
+  unlink(PATH);
+
+  // A stale socket file, with nobody listening, is replaced.
+  int stale = socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un addr = socketAddress();
+  EXPECT(bind(stale, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+  close(stale);
+  EXPECT(isSocket());
+
+  int status = -1;
+  thread server([&] { status = runServer(PATH); });
+  int client = connectToServer();
+  EXPECT(client >= 0);
+
+  // A second server does not take over the running one's socket.
+  EXPECT(runServerQuietly() == EXIT_FAILURE);
+  EXPECT(isSocket());
+
+  // Many requests before reading any reply.
+  const size_t requests = 20000;
+  string batch;
+  for (size_t r = 0; r < requests; r++) batch += r % 2 ? "total\n" : "material Material 3\r\n";
+  EXPECT(sendAll(client, batch));
+  vector<string> replies = readLines(client, requests);
+  EXPECT(replies.size() == requests);
+  for (size_t r = 0; r < replies.size(); r++) EXPECT(replies[r].compare(0, 3, "OK ") == 0);
+
+  // An overlong line ends only that connection. The server may close it
+  // before all of it is sent.
+  int flooder = connectToServer();
+  sendAll(flooder, string(200 * 1024, 'x'));
+  vector<string> flooded = readLines(flooder, 2);
+  EXPECT(flooded.size() == 1 && flooded[0].compare(0, 4, "ERR ") == 0);
+  close(flooder);
+  EXPECT(sendAll(client, "total\n"));
+  EXPECT(readLines(client, 1).size() == 1);
+
+  // A client cannot make the server write a file of its choosing.
+  const char* target = "test_server_report.txt";
+  unlink(target);
+  EXPECT(sendAll(client, string("report ") + target + "\n"));
+  vector<string> refused = readLines(client, 1);
+  EXPECT(refused.size() == 1 && refused[0].compare(0, 4, "ERR ") == 0);
+  EXPECT(access(target, F_OK) != 0);
+
+  EXPECT(sendAll(client, "shutdown\n"));
+  vector<string> last = readLines(client, 1);
+  EXPECT(last.size() == 1 && last[0] == "OK");
+  server.join();
+  close(client);
+  EXPECT(status == EXIT_SUCCESS);
+  EXPECT(!isSocket());
+  return testResult("server");
+}
@@ -0,0 +1,137 @@
+// Snapshot round trips, replacing a snapshot that is mapped, and headers
+// whose counts would overflow the bounds checks or the offset arrays.
+#include "testing.h"
+#include "../snapshot.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <unistd.h>
+
+using namespace std;
+
+// Field offsets in the SnapshotHeader of this layout.
+static_assert(SNAPSHOT_VERSION == 1, "update the header offsets below");
+static const size_t MATERIALS_FIELD = 16;
+static const size_t ENTRIES_FIELD = 32;
+static const size_t WORKERS_FIELD = 48;
+
+static string readFile(const string& path) {
+  ifstream in(path, ios::binary);
+  return string(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+}
+
+static void writeFile(const string& path, const string& bytes) {
+  ofstream(path, ios::binary).write(bytes.data(), static_cast<streamsize>(bytes.size()));
+}
+
+static void patch(string& bytes, size_t offset, uint64_t value) {
+  memcpy(&bytes[offset], &value, sizeof(value));
+}
+
+template <typename T>
+static bool sameArray(const CatalogArray<T>& a, const CatalogArray<T>& b) {
+  return a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+}
+
+int main() {
+  const string path = "test_snapshot.bin", corrupt = "test_snapshot_corrupt.bin";
+  mt19937 rng(11);
+  string error;
+  for (int round = 0; round < 20; round++) {
+    randomCatalog(rng, 1 + static_cast<int>(rng() % 40), static_cast<int>(rng() % 60));
+    vector<Materials> materials = materialDatabase;
+    vector<Commodity> commodities = commodityDatabase;
+    BillOfMaterials bom = billOfMaterials, inputs = materialInputs;
+    EXPECT(writeSnapshot(path, error));
+    releaseCatalog();
+    EXPECT(loadSnapshot(path, error));
+
+    EXPECT(materialDatabase.size() == materials.size());
+    for (size_t m = 0; m < materials.size() && m < materialDatabase.size(); m++) {
+      EXPECT(materialDatabase[m].name == materials[m].name);
+      EXPECT(sameBits(materialDatabase[m].inventory, materials[m].inventory));
+      EXPECT(materialDatabase[m].cost == materials[m].cost);
+    }
+    EXPECT(commodityDatabase.size() == commodities.size());
+    for (size_t c = 0; c < commodities.size() && c < commodityDatabase.size(); c++) {
+      EXPECT(commodityDatabase[c].name == commodities[c].name);
+      EXPECT(commodityDatabase[c].workers.size() == commodities[c].workers.size());
+    }
+    EXPECT(billOfMaterials.materialIds.viewed() && billOfMaterials.rowStart.viewed());
+    EXPECT(sameArray(billOfMaterials.rowStart, bom.rowStart));
+    EXPECT(sameArray(billOfMaterials.materialIds, bom.materialIds));
+    EXPECT(sameArray(billOfMaterials.usageRates, bom.usageRates));
+    EXPECT(sameArray(materialInputs.rowStart, inputs.rowStart));
+
+    // Changing a row copies the viewed matrix and leaves the file alone.
+    if (!commodities.empty()) {
+      int c = static_cast<int>(rng() % commodities.size());
+      billOfMaterials.replaceRow(c, {0}, {2.5});
+      bom.replaceRow(c, {0}, {2.5});
+      EXPECT(!billOfMaterials.materialIds.viewed());
+      EXPECT(sameArray(billOfMaterials.rowStart, bom.rowStart));
+      EXPECT(sameArray(billOfMaterials.materialIds, bom.materialIds));
+      EXPECT(sameArray(billOfMaterials.usageRates, bom.usageRates));
+    }
+    releaseCatalog();
+  }
+
+  // Writing over a snapshot that is in use replaces the file instead of
+  // rewriting it, so the loaded catalog keeps viewing the old contents.
+  randomCatalog(rng, 30, 40);
+  EXPECT(writeSnapshot(path, error));
+  releaseCatalog();
+  EXPECT(loadSnapshot(path, error));
+  BillOfMaterials mapped = billOfMaterials;
+  EXPECT(mapped.usageRates.viewed());
+  vector<double> rates(mapped.usageRates.begin(), mapped.usageRates.end());
+  size_t snapshotSize = readFile(path).size();
+  randomCatalog(rng, 3, 2);
+  EXPECT(writeSnapshot(path, error));
+  EXPECT(readFile(path).size() < snapshotSize);
+  EXPECT(equal(rates.begin(), rates.end(), mapped.usageRates.begin(), mapped.usageRates.end()));
+  EXPECT(access((path + ".tmp." + to_string(getpid())).c_str(), F_OK) != 0);
+  mapped = BillOfMaterials();
+  releaseCatalog();
+  EXPECT(loadSnapshot(path, error));
+  EXPECT(materialDatabase.size() == 3 && commodityDatabase.size() == 2);
+
+  // A target that cannot be replaced is reported, and no temporary is left.
+  error.clear();
+  EXPECT(!writeSnapshot("no_such_directory/snapshot.bin", error));
+  EXPECT(!error.empty());
+
+  // Counts raised by 2^62 still match every section size once multiplied by
+  // 4 or 8, and the offset checks would then read far past the mapping.
+  randomCatalog(rng, 5, 5);
+  EXPECT(writeSnapshot(path, error));
+  for (size_t field : {MATERIALS_FIELD, ENTRIES_FIELD, WORKERS_FIELD}) {
+    string bytes = readFile(path);
+    uint64_t count;
+    memcpy(&count, &bytes[field], sizeof(count));
+    patch(bytes, field, count + (uint64_t(1) << 62));
+    writeFile(corrupt, bytes);
+    error.clear();
+    EXPECT(!loadSnapshot(corrupt, error));
+    EXPECT(error.find("corrupt") != string::npos);
+  }
+
+  // materials + 1 wraps to 0.
+  string bytes = readFile(path);
+  patch(bytes, MATERIALS_FIELD, UINT64_MAX);
+  writeFile(corrupt, bytes);
+  error.clear();
+  EXPECT(!loadSnapshot(corrupt, error));
+  EXPECT(error.find("corrupt") != string::npos);
+
+  // Every prefix of a valid snapshot is rejected.
+  bytes = readFile(path);
+  for (size_t length = 0; length < bytes.size(); length += 1 + length / 16) {
+    writeFile(corrupt, bytes.substr(0, length));
+    EXPECT(!loadSnapshot(corrupt, error));
+  }
+  remove(path.c_str());
+  remove(corrupt.c_str());
+  return testResult("snapshot");
+}
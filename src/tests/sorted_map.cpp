@@ -0,0 +1,130 @@
+// nlohmann::sorted_json against nlohmann::json (std::map objects): parsing
+// text and binary formats, with and without a parser callback, and editing
+// objects afterwards must give the same documents.
+#include "testing.h"
+
+#include <map>
+#include <nlohmann/json.hpp>
+
+using namespace std;
+using nlohmann::json;
+using nlohmann::sorted_json;
+
+static mt19937 rng(25);
+
+static string randomKey() {
+  static const char* keys[] = {"a", "b", "name", "zeta", "inventory", "cost", "x1", "x10", "x2", "", "longer key that is not small"};
+  return keys[rng() % 11];
+}
+
+// Small objects with frequent duplicate keys, nested a few levels deep.
+static string randomDocument(int depth) {
+  int kind = static_cast<int>(rng() % (depth > 3 ? 3 : 6));
+  switch (kind) {
+    case 0: return to_string(static_cast<int>(rng() % 1000) - 500);
+    case 1: return "\"s" + to_string(rng() % 50) + "\"";
+    case 2: return to_string((rng() % 10000) / 7.0);
+    case 3: {
+      string text = "[";
+      for (int i = 0, n = static_cast<int>(rng() % 5); i < n; i++) text += (i ? "," : "") + randomDocument(depth + 1);
+      return text + "]";
+    }
+    default: {
+      string text = "{";
+      for (int i = 0, n = static_cast<int>(rng() % 8); i < n; i++) text += (i ? ",\"" : "\"") + randomKey() + "\":" + randomDocument(depth + 1);
+      return text + "}";
+    }
+  }
+}
+
+static void editBoth(json& a, sorted_json& b) {
+  for (int k = 0; k < 6; k++) {
+    string key = randomKey();
+    EXPECT(a.count(key) == b.count(key));
+    EXPECT(a.contains(key) == b.contains(key));
+    if (a.contains(key)) EXPECT(a.at(key).dump() == b.at(key).dump());
+    switch (rng() % 4) {
+      case 0:
+        a.erase(key);
+        b.erase(key);
+        break;
+      case 1:
+        a[key] = k;
+        b[key] = k;
+        break;
+      case 2:
+        a.emplace(key, "e");
+        b.emplace(key, "e");
+        break;
+      default: {
+        auto ia = a.find(key);
+        auto ib = b.find(key);
+        EXPECT((ia == a.end()) == (ib == b.end()));
+        if (ia != a.end() && ib != b.end()) {
+          a.erase(ia);
+          b.erase(ib);
+        }
+      }
+    }
+  }
+  json patch = json::parse(randomDocument(4));
+  if (patch.is_object()) {
+    a.update(patch);
+    b.update(sorted_json::parse(patch.dump()));
+  }
+}
+
+int main() {
+  for (int i = 0; i < 20000; i++) {
+    string text = randomDocument(0);
+    json a = json::parse(text);
+    sorted_json b = sorted_json::parse(text);
+    EXPECT(a.dump() == b.dump());
+    EXPECT(json::to_cbor(a) == sorted_json::to_cbor(b));
+    EXPECT(sorted_json::from_msgpack(json::to_msgpack(a)).dump() == a.dump());
+    EXPECT(sorted_json::from_cbor(json::to_cbor(a)).dump() == a.dump());
+
+    // Everything kept, and every "zeta" member and every object holding "x1"
+    // dropped.
+    EXPECT(sorted_json::parse(text, [](int, sorted_json::parse_event_t, sorted_json&) { return true; }).dump() == a.dump());
+    auto dropA = [](int, json::parse_event_t event, json& value) {
+      if (event == json::parse_event_t::key) return value != "zeta";
+      return !(event == json::parse_event_t::object_end && value.contains("x1"));
+    };
+    auto dropB = [](int, sorted_json::parse_event_t event, sorted_json& value) {
+      if (event == sorted_json::parse_event_t::key) return value != "zeta";
+      return !(event == sorted_json::parse_event_t::object_end && value.contains("x1"));
+    };
+    EXPECT(json::parse(text, dropA).dump() == sorted_json::parse(text, dropB).dump());
+
+    if (a.is_object()) {
+      editBoth(a, b);
+      EXPECT(a.dump() == b.dump());
+    }
+  }
+
+  // One large object with keys in random order and some repeated, like a
+  // materials file; the last of repeated keys wins.
+  string text = "{";
+  map<string, int> expected;
+  for (int i = 0; i < 50000; i++) {
+    string key = "Material " + to_string(rng() % 40000);
+    expected[key] = i;
+    text += (i ? ",\"" : "\"") + key + "\":" + to_string(i);
+  }
+  text += "}";
+  sorted_json large = sorted_json::parse(text);
+  EXPECT(large.dump() == json(expected).dump());
+  EXPECT(large.dump() == json::parse(text).dump());
+
+  sorted_json list = {{"z", 1}, {"a", 2}, {"z", 3}, {"m", {{"q", 1}, {"b", 2}}}};
+  json reference = {{"z", 1}, {"a", 2}, {"z", 3}, {"m", {{"q", 1}, {"b", 2}}}};
+  EXPECT(list.dump() == reference.dump());
+  sorted_json fromMap = map<string, int>{{"k", 1}, {"c", 2}};
+  EXPECT(fromMap.dump() == "{\"c\":2,\"k\":1}");
+  EXPECT((fromMap.get<map<string, int>>().size() == 2));
+  sorted_json erased = {{"a", 1}, {"b", 2}, {"c", 3}, {"d", 4}};
+  erased.erase(next(erased.begin()), prev(erased.end()));
+  EXPECT(erased.dump() == "{\"a\":1,\"d\":4}");
+  return testResult("sorted_map");
+}
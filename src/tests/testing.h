@@ -0,0 +1,109 @@
+#ifndef TESTING_H
+#define TESTING_H
+
+// Helpers shared by the tests that `make check` runs. Each test is a program
+// that exits non-zero when an EXPECT failed.
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../catalog.h"
+
+static int failures = 0;
+
+#define EXPECT(condition)                                                             \
+  do {                                                                                \
+    if (!(condition)) {                                                               \
+      std::cerr << __FILE__ << ":" << __LINE__ << ": expected " #condition << std::endl; \
+      failures++;                                                                     \
+    }                                                                                 \
+  } while (0)
+
+inline int testResult(const char* name) {
+  std::cout << name << ": " << (failures ? "FAILED" : "ok") << std::endl;
+  return failures ? 1 : 0;
+}
+
+// Exact comparison, so that results claimed to be bit-identical are.
+inline bool sameBits(double a, double b) {
+  return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+inline bool sameBits(const std::vector<double>& a, const std::vector<double>& b) {
+  if (a.size() != b.size()) return false;
+  for (size_t i = 0; i < a.size(); i++) {
+    if (!sameBits(a[i], b[i])) return false;
+  }
+  return true;
+}
+
+// Replaces the catalog with a random one. Demands and priorities are drawn
+// from small sets so the plan order has many ties, inventories are often
+// exhausted part way through a material's users, some priorities fall
+// outside the named levels, and some rows list a material twice, which the
+// loader accepts.
+inline void randomCatalog(std::mt19937& rng, int materials, int commodities, int maxRow = 6) {
+  releaseCatalog();
+  auto uniform = [&](int n) { return static_cast<int>(rng() % static_cast<unsigned>(n)); };
+  for (int m = 0; m < materials; m++) {
+    Materials& material = materialDatabase[internMaterial("Material " + std::to_string(m))];
+    material.inventory = uniform(4) == 0 ? 0.0 : uniform(2000) / 4.0;
+    material.production_capacity = uniform(3) == 0 ? 0.0 : uniform(500) / 8.0;
+    material.cost = static_cast<float>(uniform(400)) / 16.0f;
+  }
+  std::vector<int> ids;
+  std::vector<double> rates;
+  for (int c = 0; c < commodities; c++) {
+    Commodity commodity{std::pmr::string("Commodity " + std::to_string(c)), 1 + uniform(20), 100 + uniform(2000),
+                        static_cast<double>(uniform(12) * 25), uniform(14) - 1, {}};
+    int workers = uniform(4);
+    for (int w = 0; w < workers; w++) {
+      commodity.workers.push_back(Worker{std::pmr::string("Worker " + std::to_string(w)), 1 + uniform(60), 0.0});
+    }
+    commodityDatabase.push_back(std::move(commodity));
+    ids.clear();
+    rates.clear();
+    int row = uniform(maxRow + 1);
+    for (int e = 0; e < row; e++) {
+      int m = uniform(materials);
+      bool repeated = false;
+      for (int id : ids) repeated = repeated || id == m;
+      if (repeated && uniform(3) != 0) continue;
+      ids.push_back(m);
+      rates.push_back(uniform(64) / 16.0 + 0.1);
+    }
+    billOfMaterials.appendRow(ids, rates);
+  }
+  materialInputs = BillOfMaterials();
+  for (int m = 0; m < materials; m++) materialInputs.appendRow({}, {});
+}
+
+// Inventories and wages that planning changes, to compare runs and to
+// restore the catalog between them.
+struct CatalogState {
+  std::vector<double> inventory;
+  std::vector<double> wages;
+
+  static CatalogState capture() {
+    CatalogState state;
+    for (const Materials& material : materialDatabase) state.inventory.push_back(material.inventory);
+    for (const Commodity& commodity : commodityDatabase) {
+      for (const Worker& worker : commodity.workers) state.wages.push_back(worker.wage);
+    }
+    return state;
+  }
+
+  void restore() const {
+    for (size_t m = 0; m < materialDatabase.size(); m++) materialDatabase[m].inventory = inventory[m];
+    size_t w = 0;
+    for (Commodity& commodity : commodityDatabase) {
+      for (Worker& worker : commodity.workers) worker.wage = wages[w++];
+    }
+  }
+};
+
+#endif